@@ -0,0 +1,63 @@
+#include "Ai_worker.h"
+
+AiWorker::AiWorker(std::function<void()> notify)
+    : notify(std::move(notify)) {
+    thread = std::thread([this]() { loop(); });
+}
+
+AiWorker::~AiWorker() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+// Начать ход: opponent выбирает выстрел по полю view с генератором rng. false - очередь полна
+bool AiWorker::request(Opponent& opponent, const Board& view, const Rng& rng) {
+    if (inFlight.load(std::memory_order_relaxed) == static_cast<int>(QUEUE_SIZE)) return false;
+    inFlight.fetch_add(1, std::memory_order_release);
+    tasks.push(Task{ &opponent, view, rng });
+    // Блокировка только закрывает окно между проверкой очереди и засыпанием рабочего потока
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wake.notify_one();
+    return true;
+}
+
+// Забрать готовый ход, не дожидаясь; false - хода ещё нет
+bool AiWorker::poll(AiMove& move) {
+    if (!moves.pop(move)) return false;
+    inFlight.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+// Дождаться всех начатых ходов и выбросить их (перед сменой или сбросом стратегии)
+void AiWorker::discard() {
+    AiMove move;
+    while (busy()) {
+        if (poll(move)) continue;
+        std::unique_lock<std::mutex> guard(sleepLock);
+        done.wait(guard, [this]() { return !moves.empty(); });
+    }
+}
+
+void AiWorker::loop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this]() { return stopping || !tasks.empty(); });
+            if (stopping) return;
+        }
+        while (tasks.pop(task)) {
+            AiMove move;
+            move.cell = task.opponent->chooseShot(task.view, task.rng);
+            move.rng = task.rng;
+            moves.push(move);
+            { std::lock_guard<std::mutex> guard(sleepLock); }
+            done.notify_all();
+            if (notify) notify();
+        }
+    }
+}
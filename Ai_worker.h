@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "Opponent.h"
+#include "Spsc_queue.h"
+
+//-----------// Ход компьютера на отдельном потоке
+
+// Основной цикл отдаёт позицию и генератор, рабочий поток вызывает chooseShot и кладёт
+// ответ в очередь без блокировок. Цикл забирает ответ, когда тот готов, и всё это время
+// продолжает обрабатывать события и рисовать кадры, сколько бы ни думала стратегия.
+// Пока ход не забран, стратегию из основного потока трогать нельзя (см. busy, discard).
+
+// Выбранный выстрел
+struct AiMove {
+    int cell;
+    Rng rng;        // генератор после хода: основной цикл продолжает с него
+};
+
+class AiWorker {
+public:
+    // notify вызывается на рабочем потоке, когда ход готов (например, разбудить цикл событий)
+    explicit AiWorker(std::function<void()> notify = nullptr);
+    ~AiWorker();
+
+    // Начать ход: opponent выбирает выстрел по полю view с генератором rng. false - очередь полна
+    bool request(Opponent& opponent, const Board& view, const Rng& rng);
+    // Забрать готовый ход, не дожидаясь; false - хода ещё нет
+    bool poll(AiMove& move);
+    // Есть ход, который ещё не забран
+    bool busy() const { return inFlight.load(std::memory_order_acquire) != 0; }
+    // Дождаться всех начатых ходов и выбросить их (перед сменой или сбросом стратегии)
+    void discard();
+
+private:
+    static const size_t QUEUE_SIZE = 4;
+
+    struct Task {
+        Opponent* opponent;
+        Board view;
+        Rng rng;
+    };
+    void loop();
+
+    SpscQueue<Task, QUEUE_SIZE> tasks;      // основной поток -> рабочий
+    SpscQueue<AiMove, QUEUE_SIZE> moves;    // рабочий -> основной
+    std::function<void()> notify;
+    std::atomic<int> inFlight{ 0 };         // начатые и не забранные ходы (не больше QUEUE_SIZE)
+    std::mutex sleepLock;                   // только чтобы спать, пока очередь пуста
+    std::condition_variable wake;           // появилась задача или пора выходить
+    std::condition_variable done;           // готов ход (для discard)
+    bool stopping = false;
+    std::thread thread;
+};
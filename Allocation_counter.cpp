@@ -0,0 +1,35 @@
+#include "Allocation_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<long long> totalAllocations{ 0 };
+thread_local long long threadAllocations = 0;
+}
+
+// Сколько раз вызывался operator new с начала работы программы, во всех потоках
+long long allocationCount() {
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+// То же только в текущем потоке
+long long threadAllocationCount() {
+    return threadAllocations;
+}
+
+// new[] и варианты с nothrow стандартная библиотека сводит к этому operator new
+void* operator new(std::size_t size) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    threadAllocations++;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+//-----------// Подсчёт выделений памяти
+
+// Глобальный operator new заменён на malloc со счётчиком. Игра и самоигра в установившемся
+// режиме не выделяют память вовсе, поэтому счётчик ничего не стоит там, где важна скорость,
+// а любое выделение в кадре или в партии сразу видно (оверлей F3, selfplay, бенчмарки).
+
+// Сколько раз вызывался operator new с начала работы программы, во всех потоках
+long long allocationCount();
+// То же только в текущем потоке
+long long threadAllocationCount();
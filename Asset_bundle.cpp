@@ -0,0 +1,234 @@
+#include "Asset_bundle.h"
+#include <SDL_image.h>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const char* const ASSET_FILES[ASSET_COUNT] = { "BG.png", "BG_Win.png", "BG_Loose.png", "BG_LB.png", "MM.png", "CR.png" };
+
+const char BUNDLE_MAGIC[8] = { 'S', 'B', 'A', 'S', 'S', 'E', 'T', '1' };
+const uint64_t PIXEL_ALIGNMENT = 64;
+
+struct BundleHeader {
+    char magic[8];
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct BundleEntry {
+    char name[32];      // имя исходного PNG
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t format;    // SDL_PIXELFORMAT_*
+    uint64_t offset;    // от начала файла
+    uint64_t size;
+};
+
+// Раскодировать PNG и привести к RGBA32 (выполняется на рабочем потоке)
+DecodedImage decodeImage(const char* file) {
+    DecodedImage decoded;
+    SDL_Surface* image = IMG_Load(file);
+    if (image != nullptr) {
+        decoded.surface = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(image);
+    }
+    if (decoded.surface == nullptr) decoded.error = IMG_GetError();
+    return decoded;
+}
+
+// Раскодировать и разбудить главный цикл, который может спать в ожидании событий.
+// Событие уходит после set_value: проснувшийся poll уже застанет картинку готовой
+void decodeAndWake(const char* file, std::promise<DecodedImage> result, Uint32 readyEvent) {
+    result.set_value(decodeImage(file));
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = readyEvent;
+    SDL_PushEvent(&event);
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + PIXEL_ALIGNMENT - 1) / PIXEL_ALIGNMENT * PIXEL_ALIGNMENT;
+}
+
+}
+
+// Собрать бандл из PNG
+bool packAssetBundle(const std::string& bundlePath) {
+    std::future<DecodedImage> decoding[ASSET_COUNT];
+    for (int i = 0; i < ASSET_COUNT; ++i) {
+        decoding[i] = std::async(std::launch::async, decodeImage, ASSET_FILES[i]);
+    }
+    SDL_Surface* images[ASSET_COUNT] = {};
+    bool ok = true;
+    for (int i = 0; i < ASSET_COUNT; ++i) {
+        DecodedImage decoded = decoding[i].get();
+        images[i] = decoded.surface;
+        if (images[i] == nullptr) {
+            std::cerr << "Failed to load " << ASSET_FILES[i] << ": " << decoded.error << std::endl;
+            ok = false;
+        }
+    }
+
+    std::string tempPath = bundlePath + ".tmp";
+    if (ok) {
+        BundleHeader header = {};
+        std::memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+        header.count = ASSET_COUNT;
+        BundleEntry entries[ASSET_COUNT] = {};
+        uint64_t offset = alignUp(sizeof(header) + sizeof(entries));
+        for (int i = 0; i < ASSET_COUNT; ++i) {
+            std::memcpy(entries[i].name, ASSET_FILES[i], std::strlen(ASSET_FILES[i]));
+            entries[i].width = images[i]->w;
+            entries[i].height = images[i]->h;
+            entries[i].pitch = images[i]->pitch;
+            entries[i].format = images[i]->format->format;
+            entries[i].offset = offset;
+            entries[i].size = static_cast<uint64_t>(images[i]->pitch) * images[i]->h;
+            offset = alignUp(offset + entries[i].size);
+        }
+
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries), sizeof(entries));
+        for (int i = 0; i < ASSET_COUNT; ++i) {
+            std::vector<char> padding(static_cast<size_t>(entries[i].offset - file.tellp()), 0);
+            file.write(padding.data(), padding.size());
+            SDL_LockSurface(images[i]);
+            file.write(static_cast<const char*>(images[i]->pixels), static_cast<std::streamsize>(entries[i].size));
+            SDL_UnlockSurface(images[i]);
+        }
+        file.close();
+        ok = !file.fail() && replaceFile(tempPath, bundlePath);
+        if (!ok) {
+            std::cerr << "Failed to write " << bundlePath << std::endl;
+            std::remove(tempPath.c_str());
+        }
+    }
+    for (SDL_Surface* image : images) {
+        if (image != nullptr) SDL_FreeSurface(image);
+    }
+    return ok;
+}
+
+AssetLoader::~AssetLoader() {
+    destroy();
+}
+
+// Начать загрузку: из бандла, если он есть, иначе раскодировать PNG на рабочих потоках
+void AssetLoader::start(const std::string& bundlePath) {
+    destroy();
+    if (openBundle(bundlePath)) return;
+    // Своё событие, а не SDL_USEREVENT: номера пользовательских событий раздаёт SDL
+    if (readyEvent == static_cast<Uint32>(-1)) readyEvent = SDL_RegisterEvents(1);
+    for (int i = 0; i < ASSET_COUNT; ++i) {
+        std::promise<DecodedImage> result;
+        slots[i].decoding = result.get_future();
+        slots[i].worker = std::async(std::launch::async, decodeAndWake, ASSET_FILES[i], std::move(result), readyEvent);
+    }
+}
+
+bool AssetLoader::openBundle(const std::string& bundlePath) {
+    {
+        std::ifstream probe(bundlePath);
+        if (!probe.is_open()) return false;
+    }
+    if (!bundle.openRead(bundlePath)) return false;
+
+    const unsigned char* data = bundle.data();
+    size_t size = bundle.size();
+    const BundleHeader* header = reinterpret_cast<const BundleHeader*>(data);
+    bool valid = size >= sizeof(BundleHeader) + ASSET_COUNT * sizeof(BundleEntry) &&
+                 std::memcmp(header->magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) == 0 && header->count == ASSET_COUNT;
+    const BundleEntry* entries = reinterpret_cast<const BundleEntry*>(data + sizeof(BundleHeader));
+    for (int i = 0; valid && i < ASSET_COUNT; ++i) {
+        const BundleEntry& entry = entries[i];
+        valid = std::strncmp(entry.name, ASSET_FILES[i], sizeof(entry.name)) == 0 &&
+                entry.offset <= size && entry.size <= size - entry.offset &&
+                static_cast<uint64_t>(entry.pitch) * entry.height <= entry.size;
+    }
+    if (!valid) {
+        std::cerr << "Ignoring damaged or outdated asset bundle: " << bundlePath << std::endl;
+        bundle.close();
+        return false;
+    }
+    for (int i = 0; i < ASSET_COUNT; ++i) {
+        slots[i].pixels = data + entries[i].offset;
+        slots[i].width = static_cast<int>(entries[i].width);
+        slots[i].height = static_cast<int>(entries[i].height);
+        slots[i].pitch = static_cast<int>(entries[i].pitch);
+        slots[i].format = entries[i].format;
+    }
+    return true;
+}
+
+bool AssetLoader::upload(SDL_Renderer* renderer, Asset asset, DecodedImage image) {
+    Slot& slot = slots[asset];
+    slot.done = true;
+    loaded++;
+    if (image.surface != nullptr) {
+        slot.texture = SDL_CreateTextureFromSurface(renderer, image.surface);
+        SDL_FreeSurface(image.surface);
+    }
+    else if (slot.pixels != nullptr) {
+        slot.texture = SDL_CreateTexture(renderer, slot.format, SDL_TEXTUREACCESS_STATIC, slot.width, slot.height);
+        if (slot.texture != nullptr) {
+            SDL_UpdateTexture(slot.texture, nullptr, slot.pixels, slot.pitch);
+            SDL_SetTextureBlendMode(slot.texture, SDL_BLENDMODE_BLEND);
+        }
+    }
+    if (slot.texture == nullptr) {
+        // Ошибка раскодирования пришла с рабочего потока, ошибка текстуры - с этого
+        std::cerr << "Failed to load " << ASSET_FILES[asset] << ": "
+                  << (image.error.empty() ? SDL_GetError() : image.error.c_str()) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Создать текстуры для картинок, которые успели загрузиться
+int AssetLoader::poll(SDL_Renderer* renderer, bool& failed) {
+    int created = 0;
+    for (int i = 0; i < ASSET_COUNT; ++i) {
+        Slot& slot = slots[i];
+        if (slot.done) continue;
+        DecodedImage image;
+        if (slot.decoding.valid()) {
+            if (slot.decoding.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+            image = slot.decoding.get();
+        }
+        if (upload(renderer, static_cast<Asset>(i), std::move(image))) created++;
+        else failed = true;
+    }
+    return created;
+}
+
+// Дождаться одной картинки
+SDL_Texture* AssetLoader::wait(SDL_Renderer* renderer, Asset asset) {
+    Slot& slot = slots[asset];
+    if (!slot.done) {
+        upload(renderer, asset, slot.decoding.valid() ? slot.decoding.get() : DecodedImage());
+    }
+    return slot.texture;
+}
+
+void AssetLoader::destroy() {
+    for (Slot& slot : slots) {
+        // Дождаться рабочих потоков, чтобы не оставить поверхности без хозяина
+        if (slot.decoding.valid()) {
+            SDL_Surface* surface = slot.decoding.get().surface;
+            if (surface != nullptr) SDL_FreeSurface(surface);
+        }
+        if (slot.worker.valid()) slot.worker.wait();
+        if (slot.texture != nullptr) SDL_DestroyTexture(slot.texture);
+        slot = Slot();
+    }
+    bundle.close();
+    loaded = 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <SDL.h>
+#include <future>
+#include <string>
+#include "Mapped_file.h"
+
+//-----------// Загрузка фоновых картинок
+
+// Картинки берутся из бандла Assets.bin - уже раскодированных пикселей в формате RGBA32,
+// которые прямо из отображённого в память файла копируются в текстуры. Если бандла нет,
+// PNG раскодируются на рабочих потоках параллельно, а текстуры создаются на главном потоке
+// по мере готовности. Бандл собирается командой "Sea_Battle --pack-assets".
+enum Asset {
+    ASSET_BG,           // фон игры
+    ASSET_WIN,          // экран победы
+    ASSET_LOOSE,        // экран поражения
+    ASSET_LB,           // экран лидерборда
+    ASSET_MM,           // главное меню
+    ASSET_CR,           // экран создателя
+    ASSET_COUNT
+};
+
+const char* const ASSET_BUNDLE = "Assets.bin";
+
+// Собрать бандл из PNG; false, если что-то не загрузилось или не записалось
+bool packAssetBundle(const std::string& bundlePath);
+
+// Картинка, раскодированная на рабочем потоке. Текст ошибки SDL у каждого потока свой,
+// поэтому он забирается там же, где случилась ошибка
+struct DecodedImage {
+    SDL_Surface* surface = nullptr;
+    std::string error;
+};
+
+class AssetLoader {
+public:
+    ~AssetLoader();
+
+    // Начать загрузку: из бандла, если он есть, иначе раскодировать PNG на рабочих потоках
+    void start(const std::string& bundlePath);
+    // Создать текстуры для картинок, которые успели загрузиться.
+    // Возвращает, сколько появилось новых; failed - какая-то картинка не загрузилась
+    int poll(SDL_Renderer* renderer, bool& failed);
+    // Дождаться одной картинки (nullptr, если она не загрузилась)
+    SDL_Texture* wait(SDL_Renderer* renderer, Asset asset);
+    // Текстура, если уже готова, иначе nullptr
+    SDL_Texture* texture(Asset asset) const { return slots[asset].texture; }
+    bool complete() const { return loaded == ASSET_COUNT; }
+    bool fromBundle() const { return bundle.isOpen(); }
+    void destroy();
+
+private:
+    struct Slot {
+        std::future<DecodedImage> decoding;     // PNG на рабочем потоке
+        std::future<void> worker;               // сам рабочий поток: после картинки он ещё шлёт readyEvent
+        const unsigned char* pixels = nullptr;  // или пиксели из бандла
+        int width = 0;
+        int height = 0;
+        int pitch = 0;
+        Uint32 format = 0;
+        SDL_Texture* texture = nullptr;
+        bool done = false;
+    };
+
+    bool openBundle(const std::string& bundlePath);
+    // Создать текстуру из готовых пикселей слота; false, если не вышло
+    bool upload(SDL_Renderer* renderer, Asset asset, DecodedImage image);
+
+    MappedFile bundle;
+    Slot slots[ASSET_COUNT];
+    int loaded = 0;
+    Uint32 readyEvent = static_cast<Uint32>(-1);    // своё событие SDL: картинка готова
+};
@@ -0,0 +1,70 @@
+#include "Batch_engine.h"
+#include "Simd_lanes.h"
+#include "Batch_kernel.h"
+
+namespace {
+
+// Процессор и система поддерживают AVX2 (система должна сохранять регистры ymm)
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+enum class Isa { Scalar, Sse2, Avx2 };
+
+Isa detectIsa() {
+    if (cpuHasAvx2()) return Isa::Avx2;
+#if defined(SIMD_LANES_SSE2)
+    return Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+// Выбирается один раз при первом обращении
+Isa engineIsa() {
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+}
+
+// Набор команд, которым играет движок: "avx2", "sse2" или "scalar"
+const char* batchEngineIsa() {
+    switch (engineIsa()) {
+    case Isa::Avx2: return "avx2";
+    case Isa::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+// Сыграть games партий поля 10x10; партия i % BATCH_GAMES пачки берёт i-й генератор от seed
+void playBatchGames(long long games, uint64_t seed, BatchStats& stats) {
+    if (games <= 0) return;
+    long long quota[BATCH_GAMES];
+    Rng rngs[BATCH_GAMES];
+    Rng seeds(seed);
+    for (int lane = 0; lane < BATCH_GAMES; ++lane) {
+        quota[lane] = games / BATCH_GAMES + (lane < games % BATCH_GAMES ? 1 : 0);
+        rngs[lane] = Rng(seeds.next());
+    }
+    if (engineIsa() == Isa::Avx2 && playBatchKernelAvx2(quota, rngs, stats)) return;
+#if defined(SIMD_LANES_SSE2)
+    playBatchKernel<LanesSse2>(quota, rngs, stats);
+#else
+    playBatchKernel<LanesScalar>(quota, rngs, stats);
+#endif
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include "Self_play.h"
+
+//-----------// Пакетный движок: много партий случайный против случайного сразу
+
+// Партии идут пачками по BATCH_GAMES: выстрелы всех партий пачки разбираются векторными
+// командами (AVX2 - 4 партии на команду, SSE2 - 2), набор команд выбирается при запуске.
+// Каждая партия пачки играет со своим генератором и вызывает его в том же порядке,
+// что playRandomGame<ClassicRules>, поэтому итог совпадает с обычными партиями до бита.
+
+const int BATCH_GAMES = 16;
+
+// Итог пакетных партий
+struct BatchStats {
+    SelfPlayStats games;
+    long long score = 0;    // сумма ChangScore первой стороны на конец партий
+};
+
+// Набор команд, которым играет движок: "avx2", "sse2" или "scalar"
+const char* batchEngineIsa();
+
+// Сыграть games партий поля 10x10; партия i % BATCH_GAMES пачки берёт i-й генератор от seed
+void playBatchGames(long long games, uint64_t seed, BatchStats& stats);
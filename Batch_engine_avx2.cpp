@@ -0,0 +1,62 @@
+#include "Batch_engine.h"
+#include "Rule_set.h"
+#include "Simd_lanes.h"
+
+//-----------// Ядро пакетного движка на AVX2
+
+// Команды AVX2 разрешены только в этом файле, и вызывается он только после проверки
+// процессора (см. Batch_engine.cpp). Все общие заголовки подключены выше, до включения
+// AVX2: их встраиваемые функции должны остаться обычными. MSVC собирает команды AVX2
+// по самим встроенным функциям, GCC - после #pragma target.
+
+#if defined(_MSC_VER) || defined(__AVX2__) || (defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__)))
+
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace {
+
+// AVX2: четыре дорожки
+struct LanesAvx2 {
+    static constexpr int LANES = 4;
+    __m256i v;
+
+    static LanesAvx2 load(const uint64_t* p) { return { _mm256_load_si256(reinterpret_cast<const __m256i*>(p)) }; }
+    void store(uint64_t* p) const { _mm256_store_si256(reinterpret_cast<__m256i*>(p), v); }
+    static LanesAvx2 broadcast(uint64_t x) { return { _mm256_set1_epi64x(static_cast<long long>(x)) }; }
+    template<int N> LanesAvx2 shl() const { return { _mm256_slli_epi64(v, N) }; }
+    template<int N> LanesAvx2 shr() const { return { _mm256_srli_epi64(v, N) }; }
+    LanesAvx2 operator&(LanesAvx2 o) const { return { _mm256_and_si256(v, o.v) }; }
+    LanesAvx2 operator|(LanesAvx2 o) const { return { _mm256_or_si256(v, o.v) }; }
+    LanesAvx2 andNot(LanesAvx2 o) const { return { _mm256_andnot_si256(o.v, v) }; }
+    int zeroMask() const {
+        return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, _mm256_setzero_si256())));
+    }
+};
+
+}
+
+#include "Batch_kernel.h"
+
+// Вариант AVX2 (false, если собран без него)
+bool playBatchKernelAvx2(const long long* quota, Rng* rngs, BatchStats& stats) {
+    playBatchKernel<LanesAvx2>(quota, rngs, stats);
+    return true;
+}
+
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC pop_options
+#endif
+
+#else
+
+#include "Batch_kernel.h"
+
+// Компилятор не умеет включать AVX2 для одного файла: остаётся SSE2
+bool playBatchKernelAvx2(const long long*, Rng*, BatchStats&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,233 @@
+#pragma once
+#include "Batch_engine.h"
+#include "Rule_set.h"
+
+//-----------// Ядро пакетного движка (общее для всех наборов команд)
+
+// Файл подключается только из Batch_engine.cpp и Batch_engine_avx2.cpp: в нём одни шаблоны,
+// и каждый файл получает свою копию ядра, собранную под свой набор команд.
+// Поля всех партий лежат по слоям: слово w слоя одной стороны у BATCH_GAMES партий подряд,
+// поэтому вектор из Vec::LANES дорожек обрабатывает столько же партий одной командой.
+
+// Поле 10x10 из Vec: слова поля, в каждой дорожке своя партия
+template<class Vec>
+struct LaneBoard {
+    static constexpr int WORDS = Bitboard::WORDS;
+    Vec words[WORDS];
+
+    // Сдвиги на 0 < N < 64 клеток, как у BasicBitboard
+    template<int N> BITBOARD_INLINE LaneBoard shl() const {
+        LaneBoard b;
+        for (int i = WORDS - 1; i > 0; --i) b.words[i] = words[i].template shl<N>() | words[i - 1].template shr<64 - N>();
+        b.words[0] = words[0].template shl<N>();
+        b.words[WORDS - 1] = b.words[WORDS - 1] & Vec::broadcast(Bitboard::LAST_MASK);
+        return b;
+    }
+    template<int N> BITBOARD_INLINE LaneBoard shr() const {
+        LaneBoard b;
+        for (int i = 0; i + 1 < WORDS; ++i) b.words[i] = words[i].template shr<N>() | words[i + 1].template shl<64 - N>();
+        b.words[WORDS - 1] = words[WORDS - 1].template shr<N>();
+        return b;
+    }
+    BITBOARD_INLINE LaneBoard operator&(const LaneBoard& o) const { LaneBoard b; for (int i = 0; i < WORDS; ++i) b.words[i] = words[i] & o.words[i]; return b; }
+    BITBOARD_INLINE LaneBoard operator|(const LaneBoard& o) const { LaneBoard b; for (int i = 0; i < WORDS; ++i) b.words[i] = words[i] | o.words[i]; return b; }
+    BITBOARD_INLINE LaneBoard andNot(const LaneBoard& o) const { LaneBoard b; for (int i = 0; i < WORDS; ++i) b.words[i] = words[i].andNot(o.words[i]); return b; }
+    BITBOARD_INLINE LaneBoard andMask(const Bitboard& mask) const {
+        LaneBoard b;
+        for (int i = 0; i < WORDS; ++i) b.words[i] = words[i] & Vec::broadcast(mask.words[i]);
+        return b;
+    }
+    // Дорожки, где поле пустое
+    BITBOARD_INLINE int zeroMask() const {
+        Vec all = words[0];
+        for (int i = 1; i < WORDS; ++i) all = all | words[i];
+        return all.zeroMask();
+    }
+};
+
+// То же, что dilate4 и dilate8 для Bitboard
+template<class Vec>
+BITBOARD_INLINE LaneBoard<Vec> laneDilate4(const LaneBoard<Vec>& b) {
+    return b | b.template shl<1>().andMask(BoardEdges<BOARD_SIZE>::NOT_FIRST_ROW)
+             | b.template shr<1>().andMask(BoardEdges<BOARD_SIZE>::NOT_LAST_ROW)
+             | b.template shl<BOARD_SIZE>() | b.template shr<BOARD_SIZE>();
+}
+template<class Vec>
+BITBOARD_INLINE LaneBoard<Vec> laneDilate8(const LaneBoard<Vec>& b) {
+    LaneBoard<Vec> column = b | b.template shl<1>().andMask(BoardEdges<BOARD_SIZE>::NOT_FIRST_ROW)
+                              | b.template shr<1>().andMask(BoardEdges<BOARD_SIZE>::NOT_LAST_ROW);
+    return column | column.template shl<BOARD_SIZE>() | column.template shr<BOARD_SIZE>();
+}
+
+// BATCH_GAMES партий случайный против случайного по правилам ClassicRules.
+// Выбор клетки - скалярный (у каждой партии свой генератор), а выстрел, поиск
+// потопленных кораблей и проверка конца партии идут векторами сразу по всем партиям
+template<class Vec>
+class BatchKernel {
+public:
+    static_assert(BATCH_GAMES % Vec::LANES == 0, "batch must split into whole vectors");
+    static constexpr int WORDS = Bitboard::WORDS;
+
+    // Партия lane играет quota[lane] партий подряд с генератором rngs[lane]
+    void play(const long long* quota, Rng* rngs, BatchStats& stats) {
+        int active = 0;
+        for (int lane = 0; lane < BATCH_GAMES; ++lane) {
+            left[lane] = quota[lane];
+            playing[lane] = left[lane] > 0;
+            if (playing[lane]) {
+                start(lane, rngs[lane]);
+                active++;
+            } else {
+                clear(lane);
+            }
+        }
+        while (active > 0) {
+            chooseShots(rngs);
+            resolveShots();
+            for (int lane = 0; lane < BATCH_GAMES; ++lane) {
+                if (!playing[lane]) continue;
+                int side = sides[lane];
+                result[lane].shots[side]++;
+                bool hit = (hitLanes >> lane) & 1;
+                if (hit) score[lane] += side == 0 ? 10 : -10;
+                if ((wonLanes >> lane) & 1) {
+                    result[lane].winner = side;
+                    stats.games.add(result[lane]);
+                    stats.score += score[lane];
+                    if (--left[lane] > 0) {
+                        start(lane, rngs[lane]);
+                    } else {
+                        playing[lane] = false;
+                        clear(lane);
+                        active--;
+                    }
+                } else if (!hit) {
+                    setSide(lane, 1 - side);
+                }
+            }
+        }
+    }
+
+private:
+    enum Layer { SHIPS, HITS, MISSES, LAYERS };
+
+    uint64_t& word(int board, int layer, int w, int lane) { return boards[board][layer][w][lane]; }
+
+    // Новая партия в дорожке lane: расстановка и порядок ходов как в playRandomGame
+    void start(int lane, Rng& rng) {
+        for (int board = 0; board < 2; ++board) {
+            Board fleet;
+            ClassicRules::fillGridWithShips(fleet, rng);
+            for (int w = 0; w < WORDS; ++w) {
+                word(board, SHIPS, w, lane) = fleet.ships.words[w];
+                word(board, HITS, w, lane) = 0;
+                word(board, MISSES, w, lane) = 0;
+            }
+        }
+        result[lane] = { 0, { 0, 0 } };
+        score[lane] = 0;
+        setSide(lane, 0);
+    }
+    // Пустая дорожка: выстрелов нет, поля пустые
+    void clear(int lane) {
+        for (int w = 0; w < WORDS; ++w) {
+            shots[w][lane] = 0;
+            for (int board = 0; board < 2; ++board) {
+                for (int layer = 0; layer < LAYERS; ++layer) word(board, layer, w, lane) = 0;
+            }
+        }
+        setSide(lane, 0);
+    }
+    // Сторона side стреляет по полю 1 - side
+    void setSide(int lane, int side) {
+        sides[lane] = side;
+        targetFirst[lane] = side == 1 ? ~0ull : 0;
+    }
+
+    // Случайная необстрелянная клетка каждой партии, тем же вызовом генератора, что randomFreeCell
+    void chooseShots(Rng* rngs) {
+        for (int lane = 0; lane < BATCH_GAMES; ++lane) {
+            if (!playing[lane]) continue;
+            int target = 1 - sides[lane];
+            Bitboard freeCells;
+            for (int w = 0; w < WORDS; ++w) {
+                freeCells.words[w] = ~(word(target, HITS, w, lane) | word(target, MISSES, w, lane));
+            }
+            freeCells.words[WORDS - 1] &= Bitboard::LAST_MASK;
+            int cell = freeCells.nth(rngs[lane].below(freeCells.count()));
+            for (int w = 0; w < WORDS; ++w) shots[w][lane] = (cell >> 6) == w ? 1ull << (cell & 63) : 0;
+        }
+    }
+
+    // Поле, по которому стреляют: слой выбирается маской targetFirst без ветвлений
+    LaneBoard<Vec> loadTarget(int layer, int first, Vec toFirst) const {
+        LaneBoard<Vec> b;
+        for (int w = 0; w < WORDS; ++w) {
+            Vec a = Vec::load(&boards[0][layer][w][first]);
+            Vec c = Vec::load(&boards[1][layer][w][first]);
+            b.words[w] = (a & toFirst) | c.andNot(toFirst);
+        }
+        return b;
+    }
+    void storeTarget(int layer, int first, Vec toFirst, const LaneBoard<Vec>& value) {
+        for (int w = 0; w < WORDS; ++w) {
+            Vec a = Vec::load(&boards[0][layer][w][first]);
+            Vec c = Vec::load(&boards[1][layer][w][first]);
+            ((value.words[w] & toFirst) | a.andNot(toFirst)).store(&boards[0][layer][w][first]);
+            (value.words[w].andNot(toFirst) | (c & toFirst)).store(&boards[1][layer][w][first]);
+        }
+    }
+
+    // Выстрелы всех партий: shootCell, surroundSunkShips и CheckShip векторами
+    void resolveShots() {
+        hitLanes = 0;
+        wonLanes = 0;
+        for (int first = 0; first < BATCH_GAMES; first += Vec::LANES) {
+            Vec toFirst = Vec::load(&targetFirst[first]);
+            LaneBoard<Vec> shot;
+            for (int w = 0; w < WORDS; ++w) shot.words[w] = Vec::load(&shots[w][first]);
+            LaneBoard<Vec> ships = loadTarget(SHIPS, first, toFirst);
+
+            LaneBoard<Vec> hit = shot & ships;
+            int missed = hit.zeroMask();
+            LaneBoard<Vec> misses = loadTarget(MISSES, first, toFirst) | shot.andNot(ships);
+            LaneBoard<Vec> hits = loadTarget(HITS, first, toFirst);
+            if (missed != (1 << Vec::LANES) - 1) {
+                hits = hits | hit;
+                storeTarget(HITS, first, toFirst, hits);
+                // Корабль потоплен, если до его клеток не дотянуться по клеткам кораблей
+                // от целой клетки: корабли не касаются друг друга, а длиннее MAX_SHIP_LENGTH не бывают
+                LaneBoard<Vec> afloat = ships.andNot(hits);
+                wonLanes |= afloat.zeroMask() << first;
+                for (int step = 1; step < ClassicRules::MAX_SHIP_LENGTH; ++step) afloat = laneDilate4(afloat) & ships;
+                LaneBoard<Vec> sunk = ships.andNot(afloat);
+                misses = misses | laneDilate8(sunk).andNot(ships);
+            }
+            // Без попаданий не тонут корабли и не кончается партия: остаются одни промахи
+            storeTarget(MISSES, first, toFirst, misses);
+            hitLanes |= (missed ^ ((1 << Vec::LANES) - 1)) << first;
+        }
+    }
+
+    // Слои полей обеих сторон: [поле][слой][слово][партия]
+    alignas(32) uint64_t boards[2][LAYERS][WORDS][BATCH_GAMES];
+    alignas(32) uint64_t shots[WORDS][BATCH_GAMES];
+    alignas(32) uint64_t targetFirst[BATCH_GAMES];  // ~0, если стреляют по полю 0
+    int sides[BATCH_GAMES];
+    bool playing[BATCH_GAMES];
+    long long left[BATCH_GAMES];
+    GameResult result[BATCH_GAMES];
+    long long score[BATCH_GAMES];
+    int hitLanes = 0;   // бит партии, где выстрел попал
+    int wonLanes = 0;   // бит партии, где не осталось целых кораблей
+};
+
+// Сыграть quota[lane] партий в каждой дорожке ядром с векторами Vec
+template<class Vec>
+void playBatchKernel(const long long* quota, Rng* rngs, BatchStats& stats) {
+    BatchKernel<Vec> kernel;
+    kernel.play(quota, rngs, stats);
+}
+
+// Вариант AVX2 (false, если собран без него)
+bool playBatchKernelAvx2(const long long* quota, Rng* rngs, BatchStats& stats);
@@ -0,0 +1,286 @@
+#include "Bench.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "Self_play.h"
+#include "Hunter.h"
+#include "Allocation_counter.h"
+#include "Batch_engine.h"
+#include "Match_snapshot.h"
+
+//-----------// Замеры
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const double BATCH_SECONDS = 0.01;
+
+volatile long long sink = 0;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}
+
+void keep(long long value) {
+    sink = sink + value;
+}
+
+void Bench::run(const std::string& name, const std::function<void(long long)>& body, const std::string& rateName) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+    // Пачка, которая идёт не меньше BATCH_SECONDS
+    long long batch = 1;
+    while (true) {
+        auto start = Clock::now();
+        body(batch);
+        double seconds = secondsSince(start);
+        if (seconds >= BATCH_SECONDS || batch >= (1ll << 40)) break;
+        batch = seconds > 0 ? std::max(batch * 2, static_cast<long long>(batch * BATCH_SECONDS / seconds * 1.2)) : batch * 100;
+    }
+
+    long long iterations = 0;
+    long long allocations = allocationCount();
+    auto start = Clock::now();
+    double seconds = 0;
+    while (seconds < minSeconds) {
+        body(batch);
+        iterations += batch;
+        seconds = secondsSince(start);
+    }
+    allocations = allocationCount() - allocations;
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = seconds * 1e9 / iterations;
+    result.allocationsPerOp = static_cast<double>(allocations) / iterations;
+    result.rateName = rateName;
+    result.rate = iterations / seconds;
+    measured.push_back(result);
+    std::cerr << name << ": " << std::fixed << std::setprecision(1) << result.nsPerOp << " ns/op" << std::endl;
+}
+
+void Bench::printTable(std::ostream& out) const {
+    out << std::left << std::setw(32) << "benchmark" << std::right << std::setw(14) << "ns/op"
+        << std::setw(12) << "allocs/op" << std::setw(16) << "ops/sec" << "\n";
+    for (const BenchResult& result : measured) {
+        out << std::left << std::setw(32) << result.name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(14) << result.nsPerOp
+            << std::setprecision(2) << std::setw(12) << result.allocationsPerOp
+            << std::setprecision(0) << std::setw(16) << result.rate << "\n";
+    }
+}
+
+void Bench::writeJson(std::ostream& out) const {
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < measured.size(); ++i) {
+        const BenchResult& result = measured[i];
+        out << std::fixed << "    { \"name\": \"" << result.name << "\""
+            << ", \"iterations\": " << result.iterations
+            << std::setprecision(3) << ", \"ns_per_op\": " << result.nsPerOp
+            << std::setprecision(4) << ", \"allocs_per_op\": " << result.allocationsPerOp
+            << std::setprecision(1) << ", \"" << (result.rateName.empty() ? "ops_per_sec" : result.rateName)
+            << "\": " << result.rate << " }" << (i + 1 < measured.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+//-----------// Замеры правил и партий
+
+namespace {
+
+const int SAMPLE_BOARDS = 64;
+
+// Поля в середине партии: флот и shots случайных выстрелов (ореолы не расставлены)
+std::vector<Board> midGameBoards(Rng& rng, int shots) {
+    std::vector<Board> boards(SAMPLE_BOARDS);
+    for (Board& board : boards) {
+        fillGridWithShips(board, rng);
+        for (int i = 0; i < shots; ++i) EnemyAttack(board, rng);
+    }
+    return boards;
+}
+
+void runRuleBenchmarks(Bench& bench) {
+    Rng rng(12345);
+
+    std::vector<Board> fleets = midGameBoards(rng, 0);
+    std::vector<Ship> ships;
+    for (int i = 0; i < SAMPLE_BOARDS; ++i) {
+        Ship ship(FLEET[rng.below(FLEET_SIZE)]);
+        ship.x = rng.below(BOARD_SIZE);
+        ship.y = rng.below(BOARD_SIZE);
+        ship.horizontal = rng.below(2) == 0;
+        ships.push_back(ship);
+    }
+    bench.run("isValidPlacement", [&](long long n) {
+        long long valid = 0;
+        for (long long i = 0; i < n; ++i) {
+            valid += isValidPlacement(ships[i % SAMPLE_BOARDS], fleets[(i / SAMPLE_BOARDS) % SAMPLE_BOARDS]);
+        }
+        keep(valid);
+    });
+
+    bench.run("fillGridWithShips", [&](long long n) {
+        long long bits = 0;
+        for (long long i = 0; i < n; ++i) {
+            Board board;
+            fillGridWithShips(board, rng);
+            bits += board.ships.words[0];
+        }
+        keep(bits);
+    });
+
+    std::vector<Board> unsurrounded = midGameBoards(rng, 50);
+    bench.run("surroundSunkShips", [&](long long n) {
+        long long bits = 0;
+        for (long long i = 0; i < n; ++i) {
+            Board board = unsurrounded[i % SAMPLE_BOARDS];
+            surroundSunkShips(board);
+            bits += board.misses.words[0];
+        }
+        keep(bits);
+    });
+
+    Board target = fleets[0];
+    bench.run("EnemyAttack", [&](long long n) {
+        long long hits = 0;
+        for (long long i = 0; i < n; ++i) {
+            if (target.shot() == Bitboard::full()) {
+                target.hits = Bitboard();
+                target.misses = Bitboard();
+            }
+            hits += EnemyAttack(target, rng);
+        }
+        keep(hits);
+    });
+
+    std::vector<Board> played = midGameBoards(rng, 40);
+    bench.run("ChangScore", [&](long long n) {
+        long long score = 0;
+        for (long long i = 0; i < n; ++i) {
+            score += ChangScore(played[i % SAMPLE_BOARDS], played[(i + 1) % SAMPLE_BOARDS]);
+        }
+        keep(score);
+    });
+    bench.run("CheckShip", [&](long long n) {
+        long long alive = 0;
+        for (long long i = 0; i < n; ++i) alive += CheckShip(played[i % SAMPLE_BOARDS]);
+        keep(alive);
+    });
+
+    // Снимок партии в середине игры: 40 выстрелов по каждому полю
+    MatchSnapshot snapshot;
+    snapshot.phase = MatchPhase::PlayerAttack;
+    snapshot.boards[0] = played[0];
+    snapshot.boards[1] = played[1];
+    snapshot.shotCount = 80;
+    uint8_t blob[SNAPSHOT_MAX_BYTES];
+    bench.run("writeSnapshot", [&](long long n) {
+        long long bytes = 0;
+        for (long long i = 0; i < n; ++i) {
+            snapshot.score = static_cast<int>(i);
+            bytes += static_cast<long long>(writeSnapshot(snapshot, blob, sizeof(blob)));
+        }
+        keep(bytes);
+    });
+    size_t blobSize = writeSnapshot(snapshot, blob, sizeof(blob));
+    bench.run("readSnapshot", [&](long long n) {
+        long long valid = 0;
+        MatchSnapshot restored;
+        for (long long i = 0; i < n; ++i) valid += readSnapshot(blob, blobSize, restored);
+        keep(valid);
+    });
+
+    // Целые партии компьютер против компьютера в одном потоке
+    const char* pairs[][2] = { { "random", "random" }, { "hunt", "hunt" }, { "hunt", "random" },
+                                 { "hunt+endgame", "hunt" } };
+    for (auto& pair : pairs) {
+        std::unique_ptr<Opponent> first = makeOpponent(pair[0]);
+        std::unique_ptr<Opponent> second = makeOpponent(pair[1]);
+        bench.run(std::string("game/") + pair[0] + "_vs_" + pair[1], [&](long long n) {
+            long long shots = 0;
+            for (long long i = 0; i < n; ++i) {
+                GameResult result = playAiGame(*first, *second, rng);
+                shots += result.shots[0] + result.shots[1];
+            }
+            keep(shots);
+        }, "games_per_sec");
+    }
+    // Те же партии случайный против случайного пакетным движком (лучший набор команд процессора)
+    uint64_t batchSeed = 1;
+    bench.run("game/random_vs_random_batch", [&](long long n) {
+        BatchStats stats;
+        playBatchGames(n, batchSeed++, stats);
+        keep(stats.games.totalShots);
+    }, "games_per_sec");
+
+    Board hunted = played[0];
+    HuntTargetOpponent hunter;
+    bench.run("HuntTargetOpponent::chooseShot", [&](long long n) {
+        long long cells = 0;
+        for (long long i = 0; i < n; ++i) {
+            hunter.reset();
+            cells += hunter.chooseShot(hunted, rng);
+        }
+        keep(cells);
+    });
+}
+
+// Печать справки
+void printUsage() {
+    std::cout << "Usage: Sea_Battle_bench [options]\n"
+              << "  --json PATH     write results as JSON (\"-\" for standard output)\n"
+              << "  --filter TEXT   run only benchmarks whose name contains TEXT\n"
+              << "  --time S        seconds per benchmark (default 0.5)\n"
+              << "  --no-render     skip the SDL renderer benchmarks\n"
+              << "  --font PATH     font for text benchmarks (default \"Minecraft Rus NEW.otf\")\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string jsonPath;
+    std::string filter;
+    std::string fontPath = "Minecraft Rus NEW.otf";
+    double minSeconds = 0.5;
+    bool render = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--json" && hasValue) jsonPath = argv[++i];
+        else if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--time" && hasValue) minSeconds = std::strtod(argv[++i], nullptr);
+        else if (arg == "--font" && hasValue) fontPath = argv[++i];
+        else if (arg == "--no-render") render = false;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    Bench bench(minSeconds, filter);
+    runRuleBenchmarks(bench);
+    if (render && !runRenderBenchmarks(bench, fontPath)) return 1;
+
+    if (jsonPath == "-") {
+        bench.writeJson(std::cout);
+    }
+    else {
+        bench.printTable(std::cout);
+        if (!jsonPath.empty()) {
+            std::ofstream file(jsonPath);
+            if (!file.is_open()) {
+                std::cerr << "Unable to open file: " << jsonPath << std::endl;
+                return 1;
+            }
+            bench.writeJson(file);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//-----------// Замеры скорости
+
+struct BenchResult {
+    std::string name;
+    long long iterations;
+    double nsPerOp;
+    double allocationsPerOp;    // вызовы operator new на операцию (память SDL не считается)
+    std::string rateName;       // например "games_per_sec"; пусто - только ns/op
+    double rate;
+};
+
+// Каждый замер вызывается пачками body(n), пока суммарное время не превысит minSeconds.
+// Размер пачки подбирается так, чтобы время чтения часов не влияло на результат.
+class Bench {
+public:
+    Bench(double minSeconds, const std::string& filter) : minSeconds(minSeconds), filter(filter) {}
+
+    // body(n) выполняет n операций; rateName - как назвать число операций в секунду
+    void run(const std::string& name, const std::function<void(long long)>& body,
+             const std::string& rateName = std::string());
+
+    const std::vector<BenchResult>& results() const { return measured; }
+    void printTable(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+
+private:
+    double minSeconds;
+    std::string filter;     // замеры, в имени которых нет этой строки, пропускаются
+    std::vector<BenchResult> measured;
+};
+
+// Не дать компилятору выбросить вычисление, результат которого не используется
+void keep(long long value);
+
+// Замеры отрисовки на программном рендерере без окна; false, если SDL не запустился
+bool runRenderBenchmarks(Bench& bench, const std::string& fontPath);
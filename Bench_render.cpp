@@ -0,0 +1,106 @@
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <iostream>
+#include "Bench.h"
+#include "Game_render.h"
+
+namespace {
+
+const int SURFACE_WIDTH = 1920;
+const int SURFACE_HEIGHT = 1080;
+const int WALL_BOARDS = 64;
+
+// Поле в середине партии с потопленными кораблями и ореолами
+Board playedBoard(Rng& rng, int shots) {
+    Board board;
+    fillGridWithShips(board, rng);
+    for (int i = 0; i < shots; ++i) EnemyAttack(board, rng);
+    surroundSunkShips(board);
+    return board;
+}
+
+}
+
+// Замеры отрисовки на программном рендерере без окна; false, если SDL не запустился
+bool runRenderBenchmarks(Bench& bench, const std::string& fontPath) {
+    // Без окна: драйвер dummy и рисование в поверхность в памяти
+    SDL_SetMainReady();
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) < 0 || TTF_Init() < 0) {
+        std::cerr << "Failed to initialize SDL: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, SURFACE_WIDTH, SURFACE_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    TTF_Font* font = TTF_OpenFont(fontPath.c_str(), 48);
+    if (renderer == nullptr || font == nullptr) {
+        std::cerr << "Failed to create offscreen renderer or font: " << SDL_GetError() << std::endl;
+        if (font != nullptr) TTF_CloseFont(font);
+        if (renderer != nullptr) SDL_DestroyRenderer(renderer);
+        if (surface != nullptr) SDL_FreeSurface(surface);
+        TTF_Quit();
+        SDL_Quit();
+        return false;
+    }
+
+    bool ok = true;
+    {
+        TextAtlas text;
+        BoardRenderer boards;
+        ok = text.load(renderer, font);
+        Rng rng(777);
+        Board own = playedBoard(rng, 40);
+        Board enemy = playedBoard(rng, 60);
+        std::vector<Board> wall;
+        for (int i = 0; i < WALL_BOARDS; ++i) wall.push_back(playedBoard(rng, rng.below(CELL_COUNT)));
+        std::vector<std::string> lines;
+        for (int i = 0; i < 12; ++i) lines.push_back(std::to_string(i + 1) + ". Игрок_" + std::to_string(i) + " " + std::to_string(990 - i * 37));
+
+        // SDL копит команды до вывода кадра, поэтому каждая операция заканчивается SDL_RenderFlush
+        if (ok) {
+            bench.run("render/TextRender", [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    TextRender(renderer, text, "w/a/s/d - передвижение", 66, 726);
+                    SDL_RenderFlush(renderer);
+                }
+            });
+            bench.run("render/LBRender", [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    LBRender(renderer, text, lines);
+                    SDL_RenderFlush(renderer);
+                }
+            });
+        }
+        bench.run("render/Player_fild_render", [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                Player_fild_render(boards, own);
+                boards.flush(renderer);
+                SDL_RenderFlush(renderer);
+            }
+        });
+        bench.run("render/renderCursor", [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                renderCursor(renderer, boards, enemy, static_cast<int>(i % BOARD_SIZE), 3);
+                SDL_RenderFlush(renderer);
+            }
+        });
+        // Стена зрителя: много мелких полей одним вызовом
+        bench.run("render/wall_64_boards", [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                for (int b = 0; b < WALL_BOARDS; ++b) {
+                    boards.queue(wall[b], (b % 8) * 240, (b / 8) * 130, 10, 12, b % 2 == 0);
+                }
+                boards.flush(renderer);
+                SDL_RenderFlush(renderer);
+            }
+        });
+    }
+
+    TTF_CloseFont(font);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    TTF_Quit();
+    SDL_Quit();
+    return ok;
+}
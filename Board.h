@@ -0,0 +1,260 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+//-----------// Битовое представление игрового поля
+
+constexpr int BOARD_SIZE = 10;
+constexpr int CELL_COUNT = BOARD_SIZE * BOARD_SIZE;
+
+// Номер клетки в битовой доске (та же адресация, что и grid[x][y])
+constexpr int cellIndex(int x, int y) {
+    return x * BOARD_SIZE + y;
+}
+
+// Количество единичных бит
+inline int popcount64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(v));
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<int>((v * 0x0101010101010101ull) >> 56);
+#endif
+}
+// Номер младшего единичного бита (v != 0)
+inline int lowestBit64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return static_cast<int>(index);
+#else
+    return popcount64((v & (0 - v)) - 1);
+#endif
+}
+
+// Сдвиги и расширения вызываются в горячих циклах ИИ; без подсказки GCC их не встраивает
+#if defined(_MSC_VER)
+#define BITBOARD_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define BITBOARD_INLINE inline __attribute__((always_inline))
+#else
+#define BITBOARD_INLINE inline
+#endif
+
+// Поле Size x Size клеток в 64-битных словах: клетка i - бит i % 64 слова i / 64.
+// Число слов известно при компиляции, поэтому циклы по словам разворачиваются
+// и классическое поле 10x10 обрабатывается как пара слов без циклов.
+template<int Size>
+struct BasicBitboard {
+    static_assert(Size >= 2 && Size < 64, "board side must fit a single shift");
+    static constexpr int CELLS = Size * Size;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+    static constexpr uint64_t LAST_MASK = CELLS % 64 == 0 ? ~0ull : (1ull << (CELLS % 64)) - 1;
+
+    uint64_t words[WORDS] = {};
+
+    static constexpr BasicBitboard full() {
+        BasicBitboard b;
+        for (int i = 0; i < WORDS; ++i) b.words[i] = ~0ull;
+        b.words[WORDS - 1] = LAST_MASK;
+        return b;
+    }
+    static constexpr BasicBitboard cell(int index) {
+        BasicBitboard b;
+        b.set(index);
+        return b;
+    }
+
+    // Слово выбирается перебором с постоянными номерами: так доска остаётся в регистрах
+    constexpr bool test(int index) const {
+        uint64_t w = 0;
+        for (int i = 0; i < WORDS; ++i) w |= (index >> 6) == i ? words[i] : 0;
+        return (w >> (index & 63)) & 1;
+    }
+    constexpr void set(int index) {
+        for (int i = 0; i < WORDS; ++i) words[i] |= (index >> 6) == i ? 1ull << (index & 63) : 0;
+    }
+    constexpr void reset(int index) {
+        for (int i = 0; i < WORDS; ++i) words[i] &= (index >> 6) == i ? ~(1ull << (index & 63)) : ~0ull;
+    }
+
+    constexpr bool any() const {
+        uint64_t all = 0;
+        for (int i = 0; i < WORDS; ++i) all |= words[i];
+        return all != 0;
+    }
+    constexpr bool none() const { return !any(); }
+    int count() const {
+        int total = 0;
+        for (int i = 0; i < WORDS; ++i) total += popcount64(words[i]);
+        return total;
+    }
+    // Номер младшей занятой клетки (доска не пустая)
+    int lowest() const {
+        for (int i = 0; i + 1 < WORDS; ++i) {
+            if (words[i] != 0) return 64 * i + lowestBit64(words[i]);
+        }
+        return 64 * (WORDS - 1) + lowestBit64(words[WORDS - 1]);
+    }
+    // Номер n-й по счёту занятой клетки (n < count())
+    int nth(int n) const {
+        uint64_t w = words[WORDS - 1];
+        int base = 64 * (WORDS - 1);
+        for (int i = 0; i + 1 < WORDS; ++i) {
+            int inWord = popcount64(words[i]);
+            if (n < inWord) {
+                w = words[i];
+                base = 64 * i;
+                break;
+            }
+            n -= inWord;
+        }
+        while (n-- > 0) w &= w - 1;
+        return base + lowestBit64(w);
+    }
+
+    // Сдвиги на 0 < n < 64 клеток в сторону больших/меньших номеров
+    constexpr BasicBitboard shl(int n) const {
+        BasicBitboard b;
+        for (int i = WORDS - 1; i > 0; --i) b.words[i] = (words[i] << n) | (words[i - 1] >> (64 - n));
+        b.words[0] = words[0] << n;
+        b.words[WORDS - 1] &= LAST_MASK;
+        return b;
+    }
+    constexpr BasicBitboard shr(int n) const {
+        BasicBitboard b;
+        for (int i = 0; i + 1 < WORDS; ++i) b.words[i] = (words[i] >> n) | (words[i + 1] << (64 - n));
+        b.words[WORDS - 1] = words[WORDS - 1] >> n;
+        return b;
+    }
+
+    constexpr BasicBitboard operator&(const BasicBitboard& o) const { BasicBitboard b; for (int i = 0; i < WORDS; ++i) b.words[i] = words[i] & o.words[i]; return b; }
+    constexpr BasicBitboard operator|(const BasicBitboard& o) const { BasicBitboard b; for (int i = 0; i < WORDS; ++i) b.words[i] = words[i] | o.words[i]; return b; }
+    constexpr BasicBitboard operator^(const BasicBitboard& o) const { BasicBitboard b; for (int i = 0; i < WORDS; ++i) b.words[i] = words[i] ^ o.words[i]; return b; }
+    constexpr BasicBitboard operator~() const { BasicBitboard b; for (int i = 0; i < WORDS; ++i) b.words[i] = ~words[i]; b.words[WORDS - 1] &= LAST_MASK; return b; }
+    constexpr BasicBitboard& operator&=(const BasicBitboard& o) { for (int i = 0; i < WORDS; ++i) words[i] &= o.words[i]; return *this; }
+    constexpr BasicBitboard& operator|=(const BasicBitboard& o) { for (int i = 0; i < WORDS; ++i) words[i] |= o.words[i]; return *this; }
+    constexpr bool operator==(const BasicBitboard& o) const {
+        for (int i = 0; i < WORDS; ++i) if (words[i] != o.words[i]) return false;
+        return true;
+    }
+    constexpr bool operator!=(const BasicBitboard& o) const { return !(*this == o); }
+};
+
+// Клетки строки y (одинаковый y во всех столбцах x)
+template<int Size>
+constexpr BasicBitboard<Size> boardRow(int y) {
+    BasicBitboard<Size> b;
+    for (int x = 0; x < Size; ++x) b.set(x * Size + y);
+    return b;
+}
+
+// Маски краёв поля: строятся при компиляции для каждого размера
+template<int Size>
+struct BoardEdges {
+    static constexpr BasicBitboard<Size> NOT_FIRST_ROW = ~boardRow<Size>(0);
+    static constexpr BasicBitboard<Size> NOT_LAST_ROW = ~boardRow<Size>(Size - 1);
+};
+
+// Сдвиги на соседнюю клетку по y (без перехода в соседний столбец)
+template<int Size>
+BITBOARD_INLINE constexpr BasicBitboard<Size> shiftYPlus(const BasicBitboard<Size>& b) {
+    return b.shl(1) & BoardEdges<Size>::NOT_FIRST_ROW;
+}
+template<int Size>
+BITBOARD_INLINE constexpr BasicBitboard<Size> shiftYMinus(const BasicBitboard<Size>& b) {
+    return b.shr(1) & BoardEdges<Size>::NOT_LAST_ROW;
+}
+// Сдвиги на соседнюю клетку по x
+template<int Size>
+BITBOARD_INLINE constexpr BasicBitboard<Size> shiftXPlus(const BasicBitboard<Size>& b) {
+    return b.shl(Size);
+}
+template<int Size>
+BITBOARD_INLINE constexpr BasicBitboard<Size> shiftXMinus(const BasicBitboard<Size>& b) {
+    return b.shr(Size);
+}
+// Клетки плюс соседи по сторонам
+template<int Size>
+BITBOARD_INLINE constexpr BasicBitboard<Size> dilate4(const BasicBitboard<Size>& b) {
+    return b | shiftYPlus(b) | shiftYMinus(b) | shiftXPlus(b) | shiftXMinus(b);
+}
+// Клетки плюс все 8 соседей
+template<int Size>
+BITBOARD_INLINE constexpr BasicBitboard<Size> dilate8(const BasicBitboard<Size>& b) {
+    BasicBitboard<Size> column = b | shiftYPlus(b) | shiftYMinus(b);
+    return column | shiftXPlus(column) | shiftXMinus(column);
+}
+
+// Связная по сторонам группа клеток из within, содержащая клетку cell
+template<int Size>
+BITBOARD_INLINE BasicBitboard<Size> connectedCells(int cell, const BasicBitboard<Size>& within) {
+    BasicBitboard<Size> group = BasicBitboard<Size>::cell(cell);
+    for (;;) {
+        BasicBitboard<Size> grown = dilate4(group) & within;
+        if (grown == group) return group;
+        group = grown;
+    }
+}
+
+// Доска в (клеток + 7) / 8 байтах (клетка i - бит i % 8 байта i / 8), для файлов и сети
+template<int Size>
+void packBitboard(const BasicBitboard<Size>& board, uint8_t* out) {
+    for (int i = 0; i < (BasicBitboard<Size>::CELLS + 7) / 8; ++i) {
+        out[i] = static_cast<uint8_t>(board.words[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+template<int Size>
+BasicBitboard<Size> unpackBitboard(const uint8_t* in) {
+    BasicBitboard<Size> board;
+    for (int i = 0; i < (BasicBitboard<Size>::CELLS + 7) / 8; ++i) {
+        board.words[i / 8] |= static_cast<uint64_t>(in[i]) << (8 * (i % 8));
+    }
+    board.words[BasicBitboard<Size>::WORDS - 1] &= BasicBitboard<Size>::LAST_MASK;
+    return board;
+}
+
+// Слои поля: целые и подбитые корабли, попадания, промахи (и ореолы), потопленные корабли
+template<int Size>
+struct BasicBoard {
+    typedef BasicBitboard<Size> Bits;
+
+    Bits ships;   // все клетки кораблей
+    Bits hits;    // попадания (подмножество ships)
+    Bits misses;  // промахи и клетки вокруг потопленных кораблей
+    Bits sunk;    // клетки потопленных кораблей (подмножество hits)
+
+    Bits shot() const { return hits | misses; }
+    Bits intact() const { return ships & ~hits; }
+};
+
+//-----------// Классическое поле 10x10
+
+typedef BasicBitboard<BOARD_SIZE> Bitboard;
+typedef BasicBoard<BOARD_SIZE> Board;
+
+const int BITBOARD_BYTES = (CELL_COUNT + 7) / 8;
+
+inline Bitboard unpackBitboard(const uint8_t* in) {
+    return unpackBitboard<BOARD_SIZE>(in);
+}
+
+// Состояние одной клетки для отрисовки
+enum class Cell { Empty, Ship, Miss, Hit };
+
+inline Cell cellAt(const Board& board, int x, int y) {
+    int index = cellIndex(x, y);
+    if (board.hits.test(index)) return Cell::Hit;
+    if (board.misses.test(index)) return Cell::Miss;
+    if (board.ships.test(index)) return Cell::Ship;
+    return Cell::Empty;
+}
@@ -0,0 +1,50 @@
+#include "Board_renderer.h"
+
+const SDL_Color EMPTY_COLOR = { 183, 180, 186, SDL_ALPHA_OPAQUE };   // Для пустой клетки
+const SDL_Color SHIP_COLOR = { 91, 110, 225, SDL_ALPHA_OPAQUE };     // Для целого корабля
+const SDL_Color MISS_COLOR = { 135, 206, 250, SDL_ALPHA_OPAQUE };    // Голубой для промаха
+const SDL_Color HIT_COLOR = { 0, 18, 129, SDL_ALPHA_OPAQUE };        // Синий для попадания
+
+// Добавить поле в очередь: x, y - левый верхний угол, step - шаг между клетками
+void BoardRenderer::queue(const Board& board, int x, int y, int cellSize, int step, bool showShips) {
+    // Те же приоритеты, что в cellAt: попадание, промах, корабль, пустая клетка
+    Bitboard hits = board.hits;
+    Bitboard misses = board.misses & ~hits;
+    Bitboard ships = showShips ? board.ships & ~hits & ~misses : Bitboard();
+    Bitboard empty = ~(hits | misses | ships);
+    queueCells(empty, x, y, cellSize, step, EMPTY_COLOR);
+    queueCells(ships, x, y, cellSize, step, SHIP_COLOR);
+    queueCells(misses, x, y, cellSize, step, MISS_COLOR);
+    queueCells(hits, x, y, cellSize, step, HIT_COLOR);
+}
+
+// Добавить клетки одного цвета
+void BoardRenderer::queueCells(Bitboard cells, int x, int y, int cellSize, int step, SDL_Color color) {
+    size_t count = static_cast<size_t>(cells.count());
+    vertices.reserve(vertices.size() + count * 4);
+    indices.reserve(indices.size() + count * 6);
+    float size = static_cast<float>(cellSize);
+    while (cells.any()) {
+        int cell = cells.lowest();
+        cells.reset(cell);
+        float left = static_cast<float>(x + (cell / BOARD_SIZE) * step);
+        float top = static_cast<float>(y + (cell % BOARD_SIZE) * step);
+        int base = static_cast<int>(vertices.size());
+        vertices.push_back({ { left, top }, color, { 0, 0 } });
+        vertices.push_back({ { left + size, top }, color, { 0, 0 } });
+        vertices.push_back({ { left + size, top + size }, color, { 0, 0 } });
+        vertices.push_back({ { left, top + size }, color, { 0, 0 } });
+        int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        indices.insert(indices.end(), quad, quad + 6);
+    }
+}
+
+// Нарисовать всё, что накопилось, одним вызовом
+void BoardRenderer::flush(SDL_Renderer* renderer) {
+    if (!indices.empty()) {
+        SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+    }
+    vertices.clear();
+    indices.clear();
+}
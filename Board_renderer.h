@@ -0,0 +1,30 @@
+#pragma once
+#include <SDL.h>
+#include <vector>
+#include "Board.h"
+
+//-----------// Отрисовка полей пачкой
+
+// Клетки поля не рисуются по одной: они собираются по состояниям (слоям Board) в общий
+// буфер вершин, и всё, что накопилось, уходит одним вызовом SDL_RenderGeometry.
+// Цвет задаётся в вершинах, поэтому сколько угодно полей рисуются за один вызов.
+class BoardRenderer {
+public:
+    // Добавить поле в очередь: x, y - левый верхний угол, step - шаг между клетками.
+    // showShips - показывать целые корабли (своё поле), иначе они как пустые клетки
+    void queue(const Board& board, int x, int y, int cellSize, int step, bool showShips);
+    // Добавить клетки одного цвета (например, ставящийся корабль)
+    void queueCells(Bitboard cells, int x, int y, int cellSize, int step, SDL_Color color);
+    // Нарисовать всё, что накопилось, одним вызовом
+    void flush(SDL_Renderer* renderer);
+
+private:
+    std::vector<SDL_Vertex> vertices;   // буферы переиспользуются между кадрами
+    std::vector<int> indices;
+};
+
+// Цвета клеток
+extern const SDL_Color EMPTY_COLOR;
+extern const SDL_Color SHIP_COLOR;
+extern const SDL_Color MISS_COLOR;
+extern const SDL_Color HIT_COLOR;
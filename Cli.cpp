@@ -0,0 +1,563 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include "Self_play.h"
+#include "Score_store.h"
+#include "Replay.h"
+#include "Game_server.h"
+#include "Load_generator.h"
+#include "Opening_book.h"
+#include "Tournament.h"
+#include "Batch_engine.h"
+#include "Match_broadcast.h"
+#include <map>
+#include <thread>
+
+//-----------// Консольная программа для запуска партий без окна
+
+// Печать справки
+void printUsage() {
+    std::cout << "Usage: Sea_Battle_cli <command> [options]\n"
+              << "Commands:\n"
+              << "  selfplay   play AI-vs-AI games on all cores\n"
+              << "             --games N    number of games (default 100000)\n"
+              << "             --threads T  worker threads (default: all cores)\n"
+              << "             --seed S     RNG seed (default: current time)\n"
+              << "             --ai NAME    first player strategy (default random)\n"
+              << "             --vs NAME    second player strategy (default: same as --ai)\n"
+              << "             --uniform    exactly uniform fleet layouts (slower)\n"
+              << "             --variant 8x8|12x12  other board sizes and fleets (random vs random only)\n"
+              << "             --batch      SIMD engine playing 16 games at once (random vs random on 10x10)\n"
+              << "  scores FILE  leaderboard tools (FILE ending in .bin is the binary store)\n"
+              << "             --import TXT   append all entries of a text leaderboard\n"
+              << "             --add NAME --score S\n"
+              << "             --generate N   append N random results (load testing)\n"
+              << "             --top N        print the best N results (default 12)\n"
+              << "             --player NAME  best, average and games of a player (binary store)\n"
+              << "  replay record FILE  append AI-vs-AI games to a replay file\n"
+              << "             --games N --ai NAME --vs NAME --seed S (as in selfplay)\n"
+              << "  replay verify FILE  re-simulate every game and check its score\n"
+              << "             --scores PATH  also report leaderboard entries without a valid replay\n"
+              << "  book FILE  build an opening book from self-play (the game loads opening.book)\n"
+              << "             --games N (default 100000)  --depth D   first shots covered (default 12)\n"
+              << "             --samples K  fleet samples per position (default 20000)\n"
+              << "             --min-visits V  games that must reach a position (default 4)  --seed S\n"
+              << "  tournament round-robin between strategies with Elo ratings\n"
+              << "             --players A,B,...  strategies (default random,hunt,hunt+endgame)\n"
+              << "             --games N    games per pair (default 1000)  --threads T  --seed S (default 1)\n"
+              << "             --csv PATH   standings (default tournament.csv)  --matches PATH  score of every pair\n"
+              << "  serve      run the match server (Linux)\n"
+              << "             --port P     TCP port (default 7777)\n"
+              << "             --unix PATH  listen on a Unix socket instead\n"
+              << "             --threads T  event loop threads (default 1)\n"
+              << "  loadgen    connect many clients to the server and measure move latency\n"
+              << "             --host H --port P | --unix PATH\n"
+              << "             --connections N  (default 1000)   --threads T (default 1)\n"
+              << "             --seconds S      (default 10)     --think MS  mean pause before a shot (default 100)\n"
+              << "             --mode random|hunt|human          opponent (default hunt)\n"
+              << "  watch      print the shots of the running game (shared memory, no effect on the game)\n"
+              << "             --name N     broadcast name (default /sea_battle_live)  --events E  stop after E events\n"
+              << "Strategies: " << opponentNames() << "\n";
+}
+
+// Чтение числового параметра вида "--name value"
+bool readOption(int argc, char* argv[], const std::string& name, long long& value) {
+    for (int i = 2; i + 1 < argc; ++i) {
+        if (name == argv[i]) {
+            value = std::strtoll(argv[i + 1], nullptr, 10);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Чтение текстового параметра вида "--name value"
+bool readOption(int argc, char* argv[], const std::string& name, std::string& value) {
+    for (int i = 2; i + 1 < argc; ++i) {
+        if (name == argv[i]) {
+            value = argv[i + 1];
+            return true;
+        }
+    }
+    return false;
+}
+
+// Есть ли в командной строке флаг вида "--name"
+bool hasFlag(int argc, char* argv[], const std::string& name) {
+    for (int i = 2; i < argc; ++i) {
+        if (name == argv[i]) return true;
+    }
+    return false;
+}
+
+// Серия партий компьютер против компьютера
+int runSelfPlayCommand(int argc, char* argv[]) {
+    long long games = 100000;
+    long long threads = 0;
+    long long seed = static_cast<long long>(std::time(nullptr));
+    readOption(argc, argv, "--games", games);
+    readOption(argc, argv, "--threads", threads);
+    readOption(argc, argv, "--seed", seed);
+    std::string first = "random";
+    readOption(argc, argv, "--ai", first);
+    std::string second = first;
+    readOption(argc, argv, "--vs", second);
+    if (games <= 0) {
+        std::cerr << "--games must be positive" << std::endl;
+        return 1;
+    }
+    if (!makeOpponent(first) || !makeOpponent(second)) {
+        std::cerr << "Unknown strategy, expected one of: " << opponentNames() << std::endl;
+        return 1;
+    }
+
+    std::string variant = "10x10";
+    readOption(argc, argv, "--variant", variant);
+    int boardSize = variant == "8x8" ? SmallRules::BOARD_SIZE : variant == "12x12" ? LargeRules::BOARD_SIZE
+                  : variant == "10x10" ? ClassicRules::BOARD_SIZE : 0;
+    if (boardSize == 0) {
+        std::cerr << "Unknown variant, expected 8x8, 10x10 or 12x12" << std::endl;
+        return 1;
+    }
+    if (boardSize != BOARD_SIZE && (first != "random" || second != "random")) {
+        std::cerr << "Only the random strategy plays on " << variant << std::endl;
+        return 1;
+    }
+
+    bool batch = hasFlag(argc, argv, "--batch");
+    if (batch && (boardSize != BOARD_SIZE || first != "random" || second != "random")) {
+        std::cerr << "--batch plays only random vs random on 10x10" << std::endl;
+        return 1;
+    }
+
+    SelfPlayOptions options;
+    options.games = games;
+    options.threads = static_cast<int>(threads);
+    options.seed = static_cast<uint64_t>(seed);
+    options.first = first;
+    options.second = second;
+    options.fleets = hasFlag(argc, argv, "--uniform") ? SamplerMode::Uniform : SamplerMode::Fast;
+    options.boardSize = boardSize;
+    options.batch = batch;
+    SelfPlayStats stats = runSelfPlay(options);
+
+    double mean = static_cast<double>(stats.winnerShots) / stats.games;
+    double variance = stats.winnerShotsSq / stats.games - mean * mean;
+    std::cout << std::fixed << std::setprecision(2)
+              << "players:         " << first << " vs " << second << " on " << variant
+              << (batch ? std::string(" (batch engine, ") + batchEngineIsa() + ")" : std::string()) << "\n"
+              << "games:           " << stats.games << "\n"
+              << "time:            " << stats.seconds << " s\n"
+              << "games/sec:       " << stats.games / stats.seconds << "\n"
+              << "shots to win:    mean " << mean
+              << ", stddev " << std::sqrt(std::max(0.0, variance))
+              << ", min " << stats.minShots << ", max " << stats.maxShots << "\n"
+              << "shots per game:  " << static_cast<double>(stats.totalShots) / stats.games << "\n"
+              << "allocations:     " << static_cast<double>(stats.allocations) / stats.games << " per game\n"
+              << "first player won " << 100.0 * stats.wins[0] / stats.games << "%" << std::endl;
+    for (const std::string& report : stats.reports) {
+        if (!report.empty()) std::cout << report << std::endl;
+    }
+    return 0;
+}
+
+// Работа с таблицей лидеров
+int runScoresCommand(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    std::string path = argv[2];
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<ScoreBoard> board = openScoreBoard(path);
+    if (!board) return 1;
+    double openMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(3) << "opened in " << openMs << " ms" << std::endl;
+
+    std::string importPath;
+    if (readOption(argc, argv, "--import", importPath)) {
+        std::ifstream file(importPath);
+        if (!file.is_open()) {
+            std::cerr << "Unable to open file: " << importPath << std::endl;
+            return 1;
+        }
+        std::string line;
+        long long imported = 0;
+        ScoreEntry entry;
+        while (std::getline(file, line)) {
+            if (parseScoreLine(line, entry) && board->add(entry.name, entry.score)) imported++;
+        }
+        std::cout << "imported " << imported << " results" << std::endl;
+    }
+
+    std::string name;
+    long long score = 0;
+    if (readOption(argc, argv, "--add", name)) {
+        if (!readOption(argc, argv, "--score", score) || !board->add(name, static_cast<int>(score))) {
+            std::cerr << "--add needs a name and --score" << std::endl;
+            return 1;
+        }
+    }
+
+    long long generate = 0;
+    if (readOption(argc, argv, "--generate", generate) && generate > 0) {
+        Rng rng(static_cast<uint64_t>(std::time(nullptr)));
+        uint64_t players = static_cast<uint64_t>(generate / 10 + 1);
+        auto begin = std::chrono::steady_clock::now();
+        for (long long i = 0; i < generate; ++i) {
+            board->add("player" + std::to_string(rng.below(players)), static_cast<int>(rng.below(600)));
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "generated " << generate << " results in " << seconds << " s" << std::endl;
+    }
+
+    std::string playerName;
+    if (readOption(argc, argv, "--player", playerName)) {
+        ScoreStore* store = dynamic_cast<ScoreStore*>(board.get());
+        PlayerStats stats;
+        if (store == nullptr) {
+            std::cerr << "--player needs a binary (.bin) store" << std::endl;
+            return 1;
+        }
+        if (!store->player(playerName, stats)) {
+            std::cout << playerName << ": no results" << std::endl;
+        }
+        else {
+            std::cout << std::setprecision(2) << stats.name << ": best " << stats.best << ", average "
+                      << stats.average() << ", games " << stats.games << std::endl;
+        }
+        return 0;
+    }
+
+    long long count = 12;
+    readOption(argc, argv, "--top", count);
+    start = std::chrono::steady_clock::now();
+    std::vector<std::string> lines = board->top(static_cast<size_t>(std::max(0ll, count)));
+    double topMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (const std::string& line : lines) std::cout << line << "\n";
+    std::cout << "top " << lines.size() << " in " << topMs << " ms" << std::endl;
+    return 0;
+}
+
+// Записать партии компьютер против компьютера (первая сторона - за игрока)
+int runReplayRecord(int argc, char* argv[], const std::string& path) {
+    long long games = 1000;
+    long long seed = static_cast<long long>(std::time(nullptr));
+    readOption(argc, argv, "--games", games);
+    readOption(argc, argv, "--seed", seed);
+    std::string first = "hunt";
+    readOption(argc, argv, "--ai", first);
+    std::string second = first;
+    readOption(argc, argv, "--vs", second);
+    std::unique_ptr<Opponent> a = makeOpponent(first);
+    std::unique_ptr<Opponent> b = makeOpponent(second);
+    if (!a || !b) {
+        std::cerr << "Unknown strategy, expected one of: " << opponentNames() << std::endl;
+        return 1;
+    }
+    ReplayWriter writer;
+    if (!writer.open(path)) return 1;
+
+    Rng rng(static_cast<uint64_t>(seed));
+    AiGame game(*a, *b);
+    Replay replay;
+    replay.name = first;
+    for (long long i = 0; i < games; ++i) {
+        replay.seed = rng.state;
+        replay.shots.clear();
+        game.start(rng);
+        replay.fleets[0] = game.board(0).ships;
+        replay.fleets[1] = game.board(1).ships;
+        bool finished = false;
+        while (!finished) {
+            finished = game.step(rng);
+            replay.shots.push_back(static_cast<uint8_t>(game.lastShot()));
+        }
+        replay.score = 100 - game.result().shots[0] + ChangScore(game.board(0), game.board(1));
+        if (!writer.write(replay)) {
+            std::cerr << "Failed to write " << path << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "recorded " << games << " games to " << path << std::endl;
+    return 0;
+}
+
+// Переиграть все партии файла и сверить счёт
+int runReplayVerify(int argc, char* argv[], const std::string& path) {
+    ReplayReader reader;
+    if (!reader.open(path)) return 1;
+
+    long long counts[5] = {};
+    long long total = 0;
+    // Проверенные пары (имя, счёт) для сверки с таблицей лидеров
+    std::map<std::pair<std::string, int>, long long> verified;
+    Replay replay;
+    auto start = std::chrono::steady_clock::now();
+    while (reader.next(replay)) {
+        ReplayCheck check = verifyReplay(replay);
+        counts[static_cast<int>(check.verdict)]++;
+        total++;
+        if (check.verdict == ReplayVerdict::Valid && !replay.name.empty()) {
+            verified[std::make_pair(replay.name, replay.score)]++;
+        }
+        else if (check.verdict != ReplayVerdict::Valid) {
+            std::cout << "game " << total << " (" << replay.name << " " << replay.score << "): "
+                      << verdictName(check.verdict);
+            if (check.verdict == ReplayVerdict::ScoreMismatch) std::cout << ", rules give " << check.score;
+            std::cout << "\n";
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(0) << "games:           " << total << "\n";
+    for (int v = 0; v < 5; ++v) {
+        std::cout << "  " << std::setw(15) << std::left << verdictName(static_cast<ReplayVerdict>(v)) << std::right
+                  << counts[v] << "\n";
+    }
+    std::cout << "games/sec:       " << (seconds > 0 ? total / seconds : 0) << std::endl;
+    if (reader.damaged()) std::cout << "file is truncated or damaged after game " << total << std::endl;
+
+    std::string scoresPath;
+    if (readOption(argc, argv, "--scores", scoresPath)) {
+        std::unique_ptr<ScoreBoard> board = openScoreBoard(scoresPath);
+        if (!board) return 1;
+        long long entries = 0;
+        long long unverified = 0;
+        ScoreEntry entry;
+        for (const std::string& line : board->top(static_cast<size_t>(-1))) {
+            if (!parseScoreLine(line, entry)) continue;
+            entries++;
+            auto found = verified.find(std::make_pair(entry.name, entry.score));
+            if (found != verified.end() && found->second > 0) {
+                found->second--;
+                continue;
+            }
+            if (unverified++ < 20) std::cout << "unverified: " << line << "\n";
+        }
+        std::cout << "leaderboard:     " << entries << " entries, " << unverified << " without a valid replay" << std::endl;
+        if (unverified > 0) return 2;
+    }
+    return counts[static_cast<int>(ReplayVerdict::Valid)] == total && !reader.damaged() ? 0 : 2;
+}
+
+// Запись и проверка партий
+int runReplayCommand(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 1;
+    }
+    std::string action = argv[2];
+    if (action == "record") return runReplayRecord(argc, argv, argv[3]);
+    if (action == "verify") return runReplayVerify(argc, argv, argv[3]);
+    printUsage();
+    return 1;
+}
+
+// Сервер партий
+int runServeCommand(int argc, char* argv[]) {
+    ServerOptions options;
+    long long port = options.port;
+    long long threads = options.threads;
+    readOption(argc, argv, "--port", port);
+    readOption(argc, argv, "--threads", threads);
+    readOption(argc, argv, "--unix", options.unixPath);
+    options.port = static_cast<int>(port);
+    options.threads = static_cast<int>(threads);
+    return runGameServer(options);
+}
+
+// Нагрузка на сервер партий
+int runLoadgenCommand(int argc, char* argv[]) {
+    LoadOptions options;
+    long long port = options.port;
+    long long connections = options.connections;
+    long long threads = options.threads;
+    std::string seconds;
+    std::string think;
+    std::string mode;
+    readOption(argc, argv, "--host", options.host);
+    readOption(argc, argv, "--unix", options.unixPath);
+    readOption(argc, argv, "--port", port);
+    readOption(argc, argv, "--connections", connections);
+    readOption(argc, argv, "--threads", threads);
+    if (readOption(argc, argv, "--seconds", seconds)) options.seconds = std::strtod(seconds.c_str(), nullptr);
+    if (readOption(argc, argv, "--think", think)) options.thinkMs = std::strtod(think.c_str(), nullptr);
+    if (readOption(argc, argv, "--mode", mode)) {
+        if (mode == "random") options.mode = JOIN_RANDOM_AI;
+        else if (mode == "hunt") options.mode = JOIN_HUNT_AI;
+        else if (mode == "human") options.mode = JOIN_HUMAN;
+        else {
+            std::cerr << "--mode must be random, hunt or human" << std::endl;
+            return 1;
+        }
+    }
+    if (connections <= 0 || options.seconds <= 0) {
+        std::cerr << "--connections and --seconds must be positive" << std::endl;
+        return 1;
+    }
+    options.port = static_cast<int>(port);
+    options.connections = static_cast<int>(connections);
+    options.threads = static_cast<int>(threads);
+    return runLoadGenerator(options);
+}
+
+// Сборка дебютной книги
+int runBookCommand(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    BookBuildOptions options;
+    long long depth = options.depth;
+    long long samples = options.samples;
+    long long minVisits = options.minVisits;
+    long long seed = static_cast<long long>(options.seed);
+    readOption(argc, argv, "--games", options.games);
+    readOption(argc, argv, "--depth", depth);
+    readOption(argc, argv, "--samples", samples);
+    readOption(argc, argv, "--min-visits", minVisits);
+    readOption(argc, argv, "--seed", seed);
+    if (options.games <= 0 || depth <= 0 || depth > CELL_COUNT || samples <= 0 || minVisits <= 0) {
+        std::cerr << "--games, --depth, --samples and --min-visits must be positive" << std::endl;
+        return 1;
+    }
+    options.depth = static_cast<int>(depth);
+    options.samples = static_cast<int>(samples);
+    options.minVisits = static_cast<int>(minVisits);
+    options.seed = static_cast<uint64_t>(seed);
+    return buildOpeningBook(options, argv[2]) ? 0 : 1;
+}
+
+// Турнир стратегий каждая с каждой
+int runTournamentCommand(int argc, char* argv[]) {
+    TournamentOptions options;
+    std::string players = "random,hunt,hunt+endgame";
+    long long threads = 0;
+    long long seed = static_cast<long long>(options.seed);
+    std::string csvPath = "tournament.csv";
+    std::string matchesPath;
+    readOption(argc, argv, "--players", players);
+    readOption(argc, argv, "--games", options.gamesPerPair);
+    readOption(argc, argv, "--threads", threads);
+    readOption(argc, argv, "--seed", seed);
+    readOption(argc, argv, "--csv", csvPath);
+    readOption(argc, argv, "--matches", matchesPath);
+    for (size_t begin = 0; begin <= players.size();) {
+        size_t end = std::min(players.find(',', begin), players.size());
+        std::string name = players.substr(begin, end - begin);
+        if (!makeOpponent(name)) {
+            std::cerr << "Unknown strategy '" << name << "', expected one of: " << opponentNames() << std::endl;
+            return 1;
+        }
+        options.players.push_back(name);
+        begin = end + 1;
+    }
+    if (options.players.size() < 2 || options.gamesPerPair <= 0) {
+        std::cerr << "--players needs at least two strategies and --games must be positive" << std::endl;
+        return 1;
+    }
+    options.threads = static_cast<int>(threads);
+    options.seed = static_cast<uint64_t>(seed);
+    TournamentResult result = runTournament(options);
+
+    std::vector<const TournamentStanding*> order;
+    for (const TournamentStanding& standing : result.standings) order.push_back(&standing);
+    std::stable_sort(order.begin(), order.end(),
+                     [](const TournamentStanding* a, const TournamentStanding* b) { return a->elo > b->elo; });
+    std::cout << result.games << " games in " << std::fixed << std::setprecision(2) << result.seconds << " s ("
+              << result.games / result.seconds << " games/sec)\n"
+              << std::left << std::setw(28) << "player" << std::right << std::setw(6) << "elo" << std::setw(9)
+              << "win %" << std::setw(12) << "shots mean" << std::setw(8) << "p10" << std::setw(6) << "p50"
+              << std::setw(6) << "p90" << "\n";
+    for (const TournamentStanding* s : order) {
+        std::cout << std::left << std::setw(28) << s->name << std::right << std::setw(6) << std::lround(s->elo)
+                  << std::setw(9) << 100 * s->winRate() << std::setw(12) << s->shotsMean() << std::setw(8)
+                  << s->shotsPercentile(0.1) << std::setw(6) << s->shotsPercentile(0.5) << std::setw(6)
+                  << s->shotsPercentile(0.9) << "\n";
+    }
+    std::cout.flush();
+    if (!writeStandingsCsv(result, csvPath)) return 1;
+    if (!matchesPath.empty() && !writeMatchesCsv(result, matchesPath)) return 1;
+    return 0;
+}
+
+// Клетка в виде "x,y"
+std::string cellText(int cell) {
+    return std::to_string(cell / BOARD_SIZE) + "," + std::to_string(cell % BOARD_SIZE);
+}
+
+// Трансляция идущей партии
+int runWatchCommand(int argc, char* argv[]) {
+    std::string name = BROADCAST_NAME;
+    long long events = 0;
+    readOption(argc, argv, "--name", name);
+    readOption(argc, argv, "--events", events);
+    BroadcastReader reader;
+    if (!reader.open(name)) return 1;
+    const char* outcomes[] = { "miss", "hit", "sunk", "won" };
+    for (long long seen = 0; events <= 0 || seen < events;) {
+        MatchDelta delta;
+        uint64_t lost = 0;
+        bool got = reader.next(delta, lost);
+        if (lost > 0) std::cout << "(" << lost << " events lost, reader too slow)" << std::endl;
+        if (!got) {
+            // Новых выстрелов нет: читатель спит и игре не мешает
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        seen++;
+        if (delta.kind == BROADCAST_NEW_MATCH) {
+            std::cout << "match " << delta.match << " started, score " << delta.score << std::endl;
+            continue;
+        }
+        std::cout << "match " << delta.match << ": " << (delta.shooter == 0 ? "player  " : "computer")
+                  << " shot " << cellText(delta.cell) << " " << (delta.outcome <= SHOT_WON ? outcomes[delta.outcome] : "?");
+        if (delta.sunkLength == 1) std::cout << " (1-deck)";
+        if (delta.sunkLength > 1) {
+            std::cout << " (" << static_cast<int>(delta.sunkLength) << "-deck from " << cellText(delta.sunkCell)
+                      << (delta.sunkHorizontal ? ", horizontal" : ", vertical") << ")";
+        }
+        std::cout << ", score " << delta.score << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::string command = argv[1];
+    if (command == "selfplay") {
+        return runSelfPlayCommand(argc, argv);
+    }
+    if (command == "scores") {
+        return runScoresCommand(argc, argv);
+    }
+    if (command == "replay") {
+        return runReplayCommand(argc, argv);
+    }
+    if (command == "book") {
+        return runBookCommand(argc, argv);
+    }
+    if (command == "tournament") {
+        return runTournamentCommand(argc, argv);
+    }
+    if (command == "serve") {
+        return runServeCommand(argc, argv);
+    }
+    if (command == "loadgen") {
+        return runLoadgenCommand(argc, argv);
+    }
+    if (command == "watch") {
+        return runWatchCommand(argc, argv);
+    }
+    printUsage();
+    return 1;
+}
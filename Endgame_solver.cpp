@@ -0,0 +1,392 @@
+#include "Endgame_solver.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include "Fleet_sampler.h"
+#include "Zobrist.h"
+
+namespace {
+
+// Перечисление расстановок дольше этого считается безнадёжным
+const long long MAX_ENUMERATE_NODES = 50000;
+// Сколько последних ходов хранится для процентилей времени
+const size_t LATENCY_SAMPLES = 1 << 16;
+
+// Исход выстрела для группы расстановок: промах, попадание или потопленный корабль
+struct Outcome {
+    Bitboard sunkShip;      // пусто, если корабль не потоплен
+    bool hit;
+    int count;              // сколько расстановок дают этот исход
+    int begin;              // где их номера в стеке групп
+    double cells;           // в среднем осталось необстрелянных клеток кораблей
+};
+
+// Исходов выстрела не больше, чем промах, ранение и потопление любого корабля через эту клетку
+const int MAX_OUTCOMES = 2 + MAX_SHIP_LENGTH * (MAX_SHIP_LENGTH + 1);
+
+}
+
+// Время хода, которое не превысила доля fraction решённых ходов
+double EndgameStats::solvePercentileMs(double fraction) const {
+    if (solveMs.empty()) return 0;
+    std::vector<float> sorted = solveMs;
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+//-----------// Таблица позиций
+
+TranspositionCache::TranspositionCache(size_t capacity)
+    : entries(std::max<size_t>(capacity, 1)) {
+    size_t size = 1;
+    while (size < 2 * entries.size()) size <<= 1;
+    index.assign(size, -1);
+    indexMask = size - 1;
+}
+
+// Место ключа в индексе; если ключа нет - пустое место, куда он встанет
+size_t TranspositionCache::probe(uint64_t key) const {
+    size_t position = static_cast<size_t>(key) & indexMask;
+    while (index[position] >= 0 && entries[index[position]].key != key) position = (position + 1) & indexMask;
+    return position;
+}
+
+// Удаление из открытой адресации: следующие ключи цепочки сдвигаются на освободившееся место
+void TranspositionCache::eraseIndex(size_t position) {
+    size_t next = position;
+    for (;;) {
+        next = (next + 1) & indexMask;
+        if (index[next] < 0) break;
+        size_t home = static_cast<size_t>(entries[index[next]].key) & indexMask;
+        // Ключ можно сдвинуть, если его место не лежит между освободившимся и текущим
+        if (((next - home) & indexMask) >= ((next - position) & indexMask)) {
+            index[position] = index[next];
+            position = next;
+        }
+    }
+    index[position] = -1;
+}
+
+void TranspositionCache::unlink(int slot) {
+    Entry& e = entries[slot];
+    if (e.prev >= 0) entries[e.prev].next = e.next;
+    else head = e.next;
+    if (e.next >= 0) entries[e.next].prev = e.prev;
+    else tail = e.prev;
+}
+
+void TranspositionCache::pushFront(int slot) {
+    Entry& e = entries[slot];
+    e.prev = -1;
+    e.next = head;
+    if (head >= 0) entries[head].prev = slot;
+    head = slot;
+    if (tail < 0) tail = slot;
+}
+
+bool TranspositionCache::find(uint64_t key, double& expected, int& cell) {
+    int slot = index[probe(key)];
+    if (slot < 0) return false;
+    if (slot != head) {
+        unlink(slot);
+        pushFront(slot);
+    }
+    expected = entries[slot].expected;
+    cell = entries[slot].cell;
+    return true;
+}
+
+void TranspositionCache::store(uint64_t key, double expected, int cell) {
+    size_t position = probe(key);
+    int slot = index[position];
+    if (slot >= 0) {
+        unlink(slot);
+    }
+    else if (used < static_cast<int>(entries.size())) {
+        slot = used++;
+        index[position] = slot;
+    }
+    else {
+        // Вытесняем самую давнюю позицию
+        slot = tail;
+        unlink(slot);
+        eraseIndex(probe(entries[slot].key));
+        index[probe(key)] = slot;
+    }
+    entries[slot].key = key;
+    entries[slot].expected = expected;
+    entries[slot].cell = cell;
+    pushFront(slot);
+}
+
+void TranspositionCache::clear() {
+    std::fill(index.begin(), index.end(), -1);
+    head = tail = -1;
+    used = 0;
+}
+
+//-----------// Решатель
+
+EndgameSolver::EndgameSolver(const EndgameSettings& settings)
+    : options(settings), cache(settings.cacheEntries) {
+    // Всё, что растёт от хода к ходу, выделяется сразу
+    layouts.reserve(static_cast<size_t>(settings.maxLayouts) + 1);
+    outcomeOf.resize(static_cast<size_t>(settings.maxLayouts) + 1);
+    counters.solveMs.reserve(LATENCY_SAMPLES);
+}
+
+// Расставить корабли с номера ship; одинаковые корабли идут по возрастанию номера положения,
+// чтобы каждая расстановка встретилась один раз
+void EndgameSolver::placeShips(int ship, int firstIndex, const Bitboard& closed, Layout& layout) {
+    if (static_cast<int>(layouts.size()) > layoutLimit || ++enumerateNodes > MAX_ENUMERATE_NODES) return;
+    if (ship == shipsLeft) {
+        // Все раненые клетки должны оказаться под кораблями
+        if ((wounded & ~layout.cells).none()) layouts.push_back(layout);
+        return;
+    }
+    // Раненые клетки, которые уже нельзя накрыть, - тупик
+    if ((wounded & closed & ~layout.cells).any()) return;
+
+    int length = lengths[ship];
+    // Остались однопалубные, а однопалубный на раненой клетке был бы потоплен
+    if (length == 1 && (wounded & ~layout.cells).any()) return;
+    const PlacementTable& table = placementTable(length);
+    for (int i = firstIndex; i < table.count; ++i) {
+        const Placement& p = table.items[i];
+        if ((p.mask & closed).any()) continue;
+        // Корабль целиком из попаданий уже был бы потоплен
+        if ((p.mask & ~wounded).none()) continue;
+        // Соседние попадания должны входить в этот же корабль
+        if ((p.halo & wounded & ~p.mask).any()) continue;
+        Bitboard saved = layout.cells;
+        layout.cells |= p.mask;
+        layout.ships[ship] = p.mask;
+        bool sameNext = ship + 1 < shipsLeft && lengths[ship + 1] == length;
+        placeShips(ship + 1, sameNext ? i + 1 : 0, closed | p.halo, layout);
+        layout.cells = saved;
+        if (static_cast<int>(layouts.size()) > layoutLimit || enumerateNodes > MAX_ENUMERATE_NODES) return;
+    }
+}
+
+bool EndgameSolver::enumerateLayouts(const Board& view, int limit) {
+    FleetConstraints c = constraintsFromBoard(view);
+    shipsLeft = 0;
+    for (int length = MAX_SHIP_LENGTH; length >= 1; --length) {
+        for (int n = 0; n < c.remaining[length]; ++n) lengths[shipsLeft++] = length;
+    }
+    wounded = view.hits & ~view.sunk;
+    layoutLimit = limit;
+    enumerateNodes = 0;
+    layouts.clear();
+
+    Layout layout;
+    layout.cells = Bitboard();
+    layout.shipCount = shipsLeft;
+    placeShips(0, 0, view.misses | dilate8(view.sunk), layout);
+    return static_cast<int>(layouts.size()) <= limit && enumerateNodes <= MAX_ENUMERATE_NODES;
+}
+
+// Число согласованных расстановок, не больше limit + 1 (-1, если перечисление слишком долгое)
+int EndgameSolver::countLayouts(const Board& view, int limit) {
+    enumerateLayouts(view, limit);
+    return enumerateNodes > MAX_ENUMERATE_NODES ? -1 : static_cast<int>(layouts.size());
+}
+
+// Ожидаемое число выстрелов до конца партии при лучшей игре; < 0 - кончился бюджет
+double EndgameSolver::expectedShots(const Board& view, uint64_t key, size_t alive, int aliveCount, int& bestCell) {
+    // Партия кончается, когда подбиты все клетки (в одной ветке либо у всех расстановок, либо ни у одной:
+    // потопленный корабль виден в исходе выстрела, а корабли целиком из попаданий не перечисляются)
+    Bitboard firstOpen = layouts[groups[alive]].cells & ~view.hits;
+    if (firstOpen.none()) {
+        bestCell = -1;
+        return 0;
+    }
+    // Расстановка известна: осталось добить её клетки
+    if (aliveCount == 1) {
+        bestCell = firstOpen.lowest();
+        return firstOpen.count();
+    }
+
+    counters.cacheLookups++;
+    double cached;
+    if (cache.find(key, cached, bestCell)) {
+        counters.cacheHits++;
+        return cached;
+    }
+    if (++searchNodes > options.maxNodes) return -1;
+    counters.nodes++;
+
+    // Клетки, где корабль стоит хотя бы в одной расстановке, и где во всех
+    Bitboard possible;
+    Bitboard certain = Bitboard::full();
+    int hitCounts[CELL_COUNT] = {};
+    for (int k = 0; k < aliveCount; ++k) {
+        Bitboard open = layouts[groups[alive + k]].cells & ~view.hits;
+        possible |= open;
+        certain &= open;
+        while (open.any()) {
+            int cell = open.lowest();
+            open.reset(cell);
+            hitCounts[cell]++;
+        }
+    }
+
+    // Верный выстрел всё равно придётся сделать, а сведения от него только помогают
+    int candidates[CELL_COUNT];
+    int candidateCount = 0;
+    if (certain.any()) {
+        candidates[candidateCount++] = certain.lowest();
+    }
+    else {
+        Bitboard cells = possible;
+        while (cells.any()) {
+            int cell = cells.lowest();
+            cells.reset(cell);
+            candidates[candidateCount++] = cell;
+        }
+        // Сначала самые вероятные попадания: хорошая граница находится раньше
+        std::sort(candidates, candidates + candidateCount, [&](int a, int b) {
+            return hitCounts[a] != hitCounts[b] ? hitCounts[a] > hitCounts[b] : a < b;
+        });
+    }
+
+    // Группы исходов этого узла лежат над вершиной стека, дети кладут свои ещё выше
+    size_t child = groupsTop;
+    if (groups.size() < child + aliveCount) groups.resize(std::max(2 * groups.size(), child + aliveCount));
+    groupsTop = child + aliveCount;
+
+    double total = static_cast<double>(aliveCount);
+    double best = 1e9;
+    bestCell = candidates[0];
+    Outcome outcomes[MAX_OUTCOMES];
+    for (int c = 0; c < candidateCount; ++c) {
+        int cell = candidates[c];
+        Bitboard rest = ~view.hits & ~Bitboard::cell(cell);
+        // Разбиваем расстановки по тому, что покажет выстрел
+        int outcomeCount = 0;
+        for (int k = 0; k < aliveCount; ++k) {
+            const Layout& layout = layouts[groups[alive + k]];
+            Outcome probe = {};
+            probe.hit = layout.cells.test(cell);
+            if (probe.hit) {
+                for (int s = 0; s < layout.shipCount; ++s) {
+                    if (!layout.ships[s].test(cell)) continue;
+                    if ((layout.ships[s] & rest).none()) probe.sunkShip = layout.ships[s];
+                    break;
+                }
+            }
+            int o = 0;
+            while (o < outcomeCount && (outcomes[o].hit != probe.hit || !(outcomes[o].sunkShip == probe.sunkShip))) ++o;
+            if (o == outcomeCount) outcomes[outcomeCount++] = probe;
+            outcomes[o].count++;
+            // Нижняя граница: каждую оставшуюся клетку корабля придётся обстрелять
+            outcomes[o].cells += (layout.cells & rest).count();
+            outcomeOf[k] = static_cast<uint8_t>(o);
+        }
+
+        double bound = 1;
+        for (int o = 0; o < outcomeCount; ++o) {
+            outcomes[o].cells /= outcomes[o].count;
+            bound += outcomes[o].cells * outcomes[o].count / total;
+        }
+        if (bound >= best) continue;
+
+        // Номера расстановок по группам исходов, в прежнем порядке
+        int fill[MAX_OUTCOMES];
+        for (int o = 0, begin = 0; o < outcomeCount; begin += outcomes[o].count, ++o) {
+            outcomes[o].begin = begin;
+            fill[o] = begin;
+        }
+        for (int k = 0; k < aliveCount; ++k) groups[child + fill[outcomeOf[k]]++] = groups[alive + k];
+
+        double value = bound;
+        for (int o = 0; o < outcomeCount && value < best; ++o) {
+            Board next = view;
+            if (!outcomes[o].hit) {
+                next.misses.set(cell);
+            }
+            else {
+                next.hits.set(cell);
+                const Bitboard& ship = outcomes[o].sunkShip;
+                if (ship.any()) {
+                    next.sunk |= ship;
+                    next.misses |= dilate8(ship) & ~ship;
+                }
+            }
+            int childCell;
+            double result = expectedShots(next, key ^ zobristChange(view, next), child + outcomes[o].begin,
+                                          outcomes[o].count, childCell);
+            if (result < 0) {
+                groupsTop = child;
+                return -1;
+            }
+            value += (result - outcomes[o].cells) * outcomes[o].count / total;
+        }
+        if (value < best) {
+            best = value;
+            bestCell = cell;
+        }
+    }
+    groupsTop = child;
+    cache.store(key, best, bestCell);
+    return best;
+}
+
+bool EndgameSolver::solve(const Board& view, int& cell, double& expected) {
+    counters.moves++;
+    auto start = std::chrono::steady_clock::now();
+    if (!enumerateLayouts(view, options.maxLayouts) || layouts.empty()) {
+        counters.tooManyLayouts++;
+        return false;
+    }
+    if (groups.size() < layouts.size()) groups.resize(layouts.size());
+    for (size_t i = 0; i < layouts.size(); ++i) groups[i] = static_cast<uint16_t>(i);
+    groupsTop = layouts.size();
+    searchNodes = 0;
+    expected = expectedShots(view, zobristKey(view), 0, static_cast<int>(layouts.size()), cell);
+    if (expected < 0 || cell < 0) {
+        counters.outOfNodes++;
+        return false;
+    }
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (counters.solveMs.size() < LATENCY_SAMPLES) counters.solveMs.push_back(ms);
+    else counters.solveMs[counters.solved % LATENCY_SAMPLES] = ms;
+    counters.solved++;
+    return true;
+}
+
+std::string EndgameSolver::report() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3)
+        << "endgame: " << counters.solved << " of " << counters.moves << " moves solved"
+        << " (" << counters.tooManyLayouts << " with too many layouts, " << counters.outOfNodes << " over budget)"
+        << ", solve ms p50 " << counters.solvePercentileMs(0.5) << " p99 " << counters.solvePercentileMs(0.99)
+        << std::setprecision(1) << ", cache hit rate " << 100 * counters.cacheHitRate() << "%"
+        << " (" << cache.size() << "/" << cache.capacity() << " positions), " << counters.nodes << " nodes";
+    return out.str();
+}
+
+//-----------// Противник
+
+EndgameOpponent::EndgameOpponent(std::unique_ptr<Opponent> base, const EndgameSettings& settings)
+    : base(std::move(base)), endgame(settings) {
+    label = std::string(this->base->name()) + "+endgame";
+}
+
+void EndgameOpponent::reset() {
+    base->reset();
+}
+
+int EndgameOpponent::chooseShot(const Board& board, Rng& rng) {
+    int cell;
+    double expected;
+    if (endgame.solve(board, cell, expected)) return cell;
+    return base->chooseShot(board, rng);
+}
+
+std::string EndgameOpponent::report() const {
+    std::string baseReport = base->report();
+    return (baseReport.empty() ? std::string() : baseReport + "\n") + endgame.report();
+}
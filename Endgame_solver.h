@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Opponent.h"
+#include "Placements.h"
+
+//-----------// Точный расчёт конца партии
+
+// Когда на поле осталось мало кораблей, все расстановки, согласованные с видимой частью
+// поля, можно перечислить. Тогда выстрел выбирается перебором так, чтобы ожидаемое
+// число оставшихся выстрелов было наименьшим (все расстановки считаются равновероятными).
+
+// Настройки решателя
+struct EndgameSettings {
+    int maxLayouts = 64;            // решать, только если расстановок не больше
+    size_t cacheEntries = 1 << 16;  // размер таблицы позиций (старые вытесняются)
+    long long maxNodes = 2000;      // позиций перебора на один ход (около 10 мс), дальше - обычная стратегия
+};
+
+// Счётчики работы решателя
+struct EndgameStats {
+    long long moves = 0;            // ходов, на которых решатель вызывался
+    long long solved = 0;           // ходов, выбранных перебором
+    long long tooManyLayouts = 0;   // расстановок больше maxLayouts
+    long long outOfNodes = 0;       // перебор не уложился в maxNodes
+    long long nodes = 0;            // позиций, посчитанных заново
+    long long cacheLookups = 0;
+    long long cacheHits = 0;
+    std::vector<float> solveMs;     // время последних решённых ходов (кольцо)
+
+    double cacheHitRate() const { return cacheLookups ? static_cast<double>(cacheHits) / cacheLookups : 0; }
+    // Время хода, которое не превысила доля fraction решённых ходов
+    double solvePercentileMs(double fraction) const;
+};
+
+// Таблица позиций: ключ Зобриста -> ожидаемое число выстрелов и лучший выстрел.
+// Размер ограничен, при переполнении вытесняется позиция, к которой дольше всего не обращались.
+// Вся память выделяется в конструкторе: индекс - открытая адресация по ключу, а не узлы в куче
+class TranspositionCache {
+public:
+    explicit TranspositionCache(size_t capacity);
+
+    bool find(uint64_t key, double& expected, int& cell);
+    void store(uint64_t key, double expected, int cell);
+    void clear();
+    size_t size() const { return static_cast<size_t>(used); }
+    size_t capacity() const { return entries.size(); }
+
+private:
+    struct Entry {
+        uint64_t key;
+        double expected;
+        int cell;
+        int prev, next;     // список от недавних к давним
+    };
+    void unlink(int slot);
+    void pushFront(int slot);
+    // Место ключа в индексе; если ключа нет - пустое место, куда он встанет
+    size_t probe(uint64_t key) const;
+    void eraseIndex(size_t position);
+
+    std::vector<Entry> entries;
+    std::vector<int> index;     // номер записи или -1; размер - степень двойки, не меньше 2 * capacity
+    size_t indexMask = 0;
+    int head = -1;
+    int tail = -1;
+    int used = 0;
+};
+
+class EndgameSolver {
+public:
+    explicit EndgameSolver(const EndgameSettings& settings = EndgameSettings());
+
+    // Лучший выстрел по видимой части поля (слой ships не читается).
+    // false - расстановок слишком много или перебор не уложился в бюджет
+    bool solve(const Board& view, int& cell, double& expectedShots);
+    // Число согласованных расстановок, не больше limit + 1 (-1, если перечисление слишком долгое)
+    int countLayouts(const Board& view, int limit);
+
+    const EndgameSettings& settings() const { return options; }
+    const EndgameStats& stats() const { return counters; }
+    std::string report() const;
+
+private:
+    // Расстановка непотопленных кораблей
+    struct Layout {
+        Bitboard cells;
+        Bitboard ships[FLEET_SIZE];
+        int shipCount;
+    };
+
+    bool enumerateLayouts(const Board& view, int limit);
+    void placeShips(int ship, int firstIndex, const Bitboard& closed, Layout& layout);
+    // Ожидаемое число выстрелов до конца партии; < 0 - кончился бюджет перебора.
+    // Живые расстановки - aliveCount номеров в groups начиная с alive
+    double expectedShots(const Board& view, uint64_t key, size_t alive, int aliveCount, int& bestCell);
+
+    EndgameSettings options;
+    EndgameStats counters;
+    TranspositionCache cache;
+    std::vector<Layout> layouts;
+    // Стек номеров расстановок: каждый узел перебора раскладывает свои расстановки по исходам
+    // выстрела над вершиной стека. Память растёт только на первых ходах, дальше переиспользуется
+    std::vector<uint16_t> groups;
+    size_t groupsTop = 0;
+    std::vector<uint8_t> outcomeOf;     // исход выстрела для каждой живой расстановки узла
+    // Перечисление расстановок
+    int lengths[FLEET_SIZE];
+    int shipsLeft = 0;
+    Bitboard wounded;
+    int layoutLimit = 0;
+    long long enumerateNodes = 0;
+    long long searchNodes = 0;
+};
+
+// Обычная стратегия, которую в конце партии сменяет точный перебор
+class EndgameOpponent : public Opponent {
+public:
+    EndgameOpponent(std::unique_ptr<Opponent> base, const EndgameSettings& settings);
+    const char* name() const override { return label.c_str(); }
+    void reset() override;
+    int chooseShot(const Board& board, Rng& rng) override;
+    std::string report() const override;
+
+    const EndgameSolver& solver() const { return endgame; }
+
+private:
+    std::unique_ptr<Opponent> base;
+    EndgameSolver endgame;
+    std::string label;
+};
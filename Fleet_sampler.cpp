@@ -0,0 +1,372 @@
+#include "Fleet_sampler.h"
+#include "Rules.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Ограничения по видимой части поля (слой ships не читается)
+FleetConstraints constraintsFromBoard(const Board& board) {
+    FleetConstraints c;
+    c.misses = board.misses;
+    c.hits = board.hits;
+    c.sunk = board.sunk;
+    for (int length = 0; length <= MAX_SHIP_LENGTH; ++length) c.remaining[length] = 0;
+    for (int length : FLEET) c.remaining[length]++;
+
+    // Вычёркиваем потопленные корабли по длинам
+    Bitboard sunk = board.sunk;
+    while (sunk.any()) {
+        Bitboard ship = connectedCells(sunk.lowest(), sunk);
+        sunk = sunk & ~ship;
+        int length = ship.count();
+        if (length <= MAX_SHIP_LENGTH && c.remaining[length] > 0) c.remaining[length]--;
+    }
+    return c;
+}
+
+namespace {
+
+// Сколько случайных положений пробовать до прохода по всей таблице
+const int PROBES = 8;
+
+// Одна попытка расстановки; false, если какой-то корабль поставить некуда
+bool tryFleet(const FleetConstraints& c, Rng& rng, Bitboard& ships) {
+    int remaining[MAX_SHIP_LENGTH + 1];
+    for (int length = 0; length <= MAX_SHIP_LENGTH; ++length) remaining[length] = c.remaining[length];
+
+    Bitboard wounded = c.hits & ~c.sunk;
+    Bitboard taken = dilate8(c.sunk);   // сюда новый корабль ставить нельзя
+    ships = Bitboard();
+
+    // Сначала накрываем раненые корабли: положение выбирается с весом числа кораблей этой длины
+    Bitboard uncovered = wounded;
+    while (uncovered.any()) {
+        int hit = uncovered.lowest();
+        const Placement* chosen = nullptr;
+        int chosenLength = 0;
+        int totalWeight = 0;
+        for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+            if (remaining[length] == 0) continue;
+            const PlacementTable& table = placementTable(length);
+            for (int k = 0; k < table.coverCount[hit]; ++k) {
+                const Placement& p = table.items[table.cover[hit][k]];
+                if ((p.mask & (c.misses | taken)).any()) continue;
+                // Корабль целиком из попаданий уже был бы потоплен
+                if ((p.mask & ~wounded).none()) continue;
+                // Соседние попадания должны входить в этот же корабль
+                if ((p.halo & wounded & ~p.mask).any()) continue;
+                totalWeight += remaining[length];
+                if (rng.below(totalWeight) < remaining[length]) {
+                    chosen = &p;
+                    chosenLength = length;
+                }
+            }
+        }
+        if (chosen == nullptr) return false;
+        ships |= chosen->mask;
+        taken |= chosen->halo;
+        uncovered = uncovered & ~chosen->mask;
+        remaining[chosenLength]--;
+    }
+
+    // Остальные корабли - равномерно среди свободных положений, начиная с длинных
+    Bitboard closed = taken | c.misses | c.hits;
+    for (int length = MAX_SHIP_LENGTH; length >= 1; --length) {
+        const PlacementTable& table = placementTable(length);
+        for (int n = 0; n < remaining[length]; ++n) {
+            const Placement* chosen = nullptr;
+            // Пока поле свободно, случайное положение из таблицы почти всегда подходит
+            for (int probe = 0; probe < PROBES && chosen == nullptr; ++probe) {
+                const Placement& p = table.items[rng.below(table.count)];
+                if ((p.mask & closed).none()) chosen = &p;
+            }
+            // Иначе один проход по таблице: работа на корабль ограничена её размером
+            if (chosen == nullptr) {
+                short candidates[MAX_PLACEMENTS];
+                int count = 0;
+                for (int i = 0; i < table.count; ++i) {
+                    if ((table.items[i].mask & closed).none()) candidates[count++] = static_cast<short>(i);
+                }
+                if (count == 0) return false;
+                chosen = &table.items[candidates[rng.below(count)]];
+            }
+            ships |= chosen->mask;
+            closed |= chosen->halo;
+        }
+    }
+    return true;
+}
+
+// Точный режим: поле проходится по строкам x, и для каждого состояния на границе строк
+// заранее считается, сколькими расстановками можно закончить поле. Строка выбирается
+// с вероятностью, пропорциональной числу продолжений, поэтому каждая допустимая
+// расстановка выпадает одинаково часто, а на расстановку уходит BOARD_SIZE шагов.
+//
+// Состояние перед строкой x - по коду на столбец y (что можно поставить в клетку (x, y))
+// и сколько кораблей каждой длины ещё не закончено:
+const int COLUMN_FREE = 0;      // строка x - 1 вокруг пуста
+const int COLUMN_BLOCKED = 1;   // рядом корабль, клетка должна остаться пустой
+const int COLUMN_RUN = 2;       // 2 + 2 * (k - 1) + f: над клеткой корабль из k клеток, может продолжиться вниз
+// f - в корабле есть клетка, по которой не попадали: корабль целиком из попаданий был бы потоплен
+
+static_assert(MAX_SHIP_LENGTH >= 2 && MAX_SHIP_LENGTH <= 7, "run codes must fit 4 bits");
+
+int columnCode(uint64_t profile, int y) {
+    return static_cast<int>((profile >> (4 * y)) & 15);
+}
+
+// Переход через строку: её клетки, состояние после неё и законченные в ней корабли
+struct RowStep {
+    int next;           // номер состояния перед следующей строкой
+    uint16_t finished;  // законченные корабли как номер набора (см. fleetIndex)
+    uint16_t row;       // занятые клетки строки, бит y - клетка (x, y)
+};
+
+static_assert(BOARD_SIZE <= 16, "a row must fit RowStep::row");
+
+class LayoutCounter {
+public:
+    explicit LayoutCounter(const FleetConstraints& c) : constraints(c) {
+        Bitboard wounded = c.hits & ~c.sunk;
+        Bitboard blocked = dilate8(c.sunk) | c.misses;
+        fleetCount = 1;
+        for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+            stride[length] = fleetCount;
+            fleetCount *= c.remaining[length] + 1;
+        }
+        fits.assign(fleetCount * fleetCount, 0);
+        for (int whole = 0; whole < fleetCount; ++whole) {
+            for (int part = 0; part < fleetCount; ++part) {
+                bool inside = true;
+                for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+                    int digits = c.remaining[length] + 1;
+                    inside = inside && whole / stride[length] % digits >= part / stride[length] % digits;
+                }
+                fits[whole * fleetCount + part] = inside;
+            }
+        }
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            required[x] = 0;
+            allowed[x] = 0;
+            for (int y = 0; y < BOARD_SIZE; ++y) {
+                if (wounded.test(cellIndex(x, y))) required[x] |= 1u << y;
+                if (!blocked.test(cellIndex(x, y))) allowed[x] |= 1u << y;
+            }
+        }
+
+        // Прямой проход: какие состояния достижимы на каждой границе строк
+        std::unordered_map<uint64_t, int> index[BOARD_SIZE + 1];
+        index[0].emplace(0, 0);
+        profiles[0].push_back(0);
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            for (size_t p = 0; p < profiles[x].size(); ++p) {
+                first[x].push_back(static_cast<int>(steps[x].size()));
+                forEachRow(x, profiles[x][p], [&](uint64_t next, int finished, uint32_t row) {
+                    auto inserted = index[x + 1].emplace(next, static_cast<int>(profiles[x + 1].size()));
+                    if (inserted.second) profiles[x + 1].push_back(next);
+                    steps[x].push_back({inserted.first->second, static_cast<uint16_t>(finished), static_cast<uint16_t>(row)});
+                });
+            }
+            first[x].push_back(static_cast<int>(steps[x].size()));
+        }
+
+        // Обратный проход: counts[x][p * fleetCount + f] - сколькими расстановками закончить
+        // поле из состояния p перед строкой x, если осталось поставить набор f
+        counts[BOARD_SIZE].assign(profiles[BOARD_SIZE].size() * fleetCount, 0);
+        for (size_t p = 0; p < profiles[BOARD_SIZE].size(); ++p) {
+            int finished = finishRuns(profiles[BOARD_SIZE][p]);
+            if (finished >= 0) counts[BOARD_SIZE][p * fleetCount + finished] = 1;
+        }
+        for (int x = BOARD_SIZE - 1; x >= 0; --x) {
+            counts[x].assign(profiles[x].size() * fleetCount, 0);
+            for (size_t p = 0; p < profiles[x].size(); ++p) {
+                uint64_t* total = &counts[x][p * fleetCount];
+                for (int s = first[x][p]; s < first[x][p + 1]; ++s) {
+                    const RowStep& step = steps[x][s];
+                    const uint64_t* after = &counts[x + 1][step.next * fleetCount];
+                    for (int f = 0; f < fleetCount; ++f) {
+                        if (contains(f, step.finished)) total[f] += after[f - step.finished];
+                    }
+                }
+            }
+        }
+        fleet = fleetCount - 1;
+    }
+
+    bool matches(const FleetConstraints& c) const {
+        if (c.misses != constraints.misses || c.hits != constraints.hits || c.sunk != constraints.sunk) return false;
+        for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+            if (c.remaining[length] != constraints.remaining[length]) return false;
+        }
+        return true;
+    }
+
+    // Равномерно случайная расстановка; false, если допустимых нет
+    bool sample(Rng& rng, Bitboard& ships) const {
+        if (counts[0][fleet] == 0) return false;
+        ships = Bitboard();
+        int p = 0;
+        int f = fleet;
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            uint64_t pick = below(rng, counts[x][p * fleetCount + f]);
+            int s = first[x][p];
+            for (;; ++s) {
+                const RowStep& step = steps[x][s];
+                if (!contains(f, step.finished)) continue;
+                uint64_t ways = counts[x + 1][step.next * fleetCount + f - step.finished];
+                if (pick < ways) break;
+                pick -= ways;
+            }
+            const RowStep& step = steps[x][s];
+            for (int y = 0; y < BOARD_SIZE; ++y) {
+                if (step.row >> y & 1) ships.set(cellIndex(x, y));
+            }
+            p = step.next;
+            f -= step.finished;
+        }
+        return true;
+    }
+
+private:
+    // Все допустимые заполнения строки x после состояния profile
+    template <typename Visit>
+    void forEachRow(int x, uint64_t profile, Visit visit) const {
+        uint32_t open = allowed[x];
+        for (int y = 0; y < BOARD_SIZE; ++y) {
+            if (columnCode(profile, y) == COLUMN_BLOCKED) open &= ~(1u << y);
+        }
+        if ((required[x] & ~open) != 0) return;
+        for (uint32_t row = open;; row = (row - 1) & open) {
+            if ((required[x] & ~row) == 0) {
+                uint64_t next;
+                int finished;
+                if (fillRow(x, profile, row, next, finished)) visit(next, finished, row);
+            }
+            if (row == 0) break;
+        }
+    }
+
+    // Состояние после строки и законченные в ней корабли; false, если строка недопустима
+    bool fillRow(int x, uint64_t profile, uint32_t row, uint64_t& next, int& finished) const {
+        int lengths[MAX_SHIP_LENGTH + 1] = {};
+        next = 0;
+        for (int y = 0; y < BOARD_SIZE;) {
+            int code = columnCode(profile, y);
+            if (!(row >> y & 1)) {
+                // Корабль сверху здесь кончается
+                if (code >= COLUMN_RUN && !finishShip(lengths, (code - COLUMN_RUN) / 2 + 1, code & 1)) return false;
+                bool touched = (y > 0 && (row >> (y - 1) & 1)) || (y + 1 < BOARD_SIZE && (row >> (y + 1) & 1));
+                next |= static_cast<uint64_t>(touched ? COLUMN_BLOCKED : COLUMN_FREE) << (4 * y);
+                ++y;
+                continue;
+            }
+            int end = y;
+            bool free = false;
+            while (end < BOARD_SIZE && (row >> end & 1)) {
+                if (!(required[x] >> end & 1)) free = true;
+                ++end;
+            }
+            int length = end - y;
+            if (length == 1) {
+                // Одна клетка: начало корабля или продолжение того, что сверху
+                int run = 1;
+                if (code >= COLUMN_RUN) {
+                    run = (code - COLUMN_RUN) / 2 + 2;
+                    free = free || (code & 1);
+                }
+                if (run == MAX_SHIP_LENGTH) {
+                    if (!finishShip(lengths, run, free)) return false;
+                    next |= static_cast<uint64_t>(COLUMN_BLOCKED) << (4 * y);
+                }
+                else {
+                    next |= static_cast<uint64_t>(COLUMN_RUN + 2 * (run - 1) + free) << (4 * y);
+                }
+            }
+            else {
+                // Корабль вдоль строки; под клетками с кораблём сверху соседи закрыты, так что сюда он не попадает
+                if (length > MAX_SHIP_LENGTH || !finishShip(lengths, length, free)) return false;
+                for (int i = y; i < end; ++i) next |= static_cast<uint64_t>(COLUMN_BLOCKED) << (4 * i);
+            }
+            y = end;
+        }
+        finished = fleetIndex(lengths);
+        return finished >= 0;
+    }
+
+    // Корабли, которые доходят до нижнего края; -1, если какой-то из них недопустим
+    int finishRuns(uint64_t profile) const {
+        int lengths[MAX_SHIP_LENGTH + 1] = {};
+        for (int y = 0; y < BOARD_SIZE; ++y) {
+            int code = columnCode(profile, y);
+            if (code >= COLUMN_RUN && !finishShip(lengths, (code - COLUMN_RUN) / 2 + 1, code & 1)) return -1;
+        }
+        return fleetIndex(lengths);
+    }
+
+    static bool finishShip(int* lengths, int length, bool hasFreeCell) {
+        if (!hasFreeCell) return false;
+        lengths[length]++;
+        return true;
+    }
+
+    // Номер набора кораблей (по сколько каждой длины); -1, если столько не осталось
+    int fleetIndex(const int* lengths) const {
+        int index = 0;
+        for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+            if (lengths[length] > constraints.remaining[length]) return -1;
+            index += lengths[length] * stride[length];
+        }
+        return index;
+    }
+
+    // Набор part входит в набор whole
+    bool contains(int whole, int part) const {
+        return fits[whole * fleetCount + part] != 0;
+    }
+
+    // Равномерное число от 0 до n - 1 без смещения
+    static uint64_t below(Rng& rng, uint64_t n) {
+        uint64_t limit = ~0ull - (~0ull % n + 1) % n;
+        uint64_t value;
+        do value = rng.next(); while (value > limit);
+        return value % n;
+    }
+
+    FleetConstraints constraints;
+    uint32_t required[BOARD_SIZE];      // раненые клетки строки
+    uint32_t allowed[BOARD_SIZE];       // клетки строки, где может стоять корабль
+    int stride[MAX_SHIP_LENGTH + 1];
+    int fleetCount;
+    int fleet;                          // весь непотопленный флот
+    std::vector<char> fits;             // fits[whole * fleetCount + part] - набор part входит в whole
+    std::vector<uint64_t> profiles[BOARD_SIZE + 1];
+    std::vector<int> first[BOARD_SIZE];             // переходы состояния p - steps[x][first[x][p]..first[x][p + 1])
+    std::vector<RowStep> steps[BOARD_SIZE];
+    std::vector<uint64_t> counts[BOARD_SIZE + 1];
+};
+
+// Счётчик строится один раз на набор ограничений и общий для всех потоков: для пустого поля
+// таблица занимает около сотни мегабайт и считается около секунды
+const LayoutCounter& counterFor(const FleetConstraints& c) {
+    thread_local std::shared_ptr<const LayoutCounter> local;
+    if (local && local->matches(c)) return *local;
+    static std::mutex lock;
+    static std::shared_ptr<const LayoutCounter> shared;
+    std::lock_guard<std::mutex> guard(lock);
+    if (!shared || !shared->matches(c)) shared = std::make_shared<const LayoutCounter>(c);
+    local = shared;
+    return *local;
+}
+
+}
+
+bool sampleFleet(const FleetConstraints& constraints, Rng& rng, Bitboard& ships,
+                 SamplerMode mode, int maxAttempts) {
+    // Точный режим не ошибается: если он не расставил флот, допустимых расстановок нет
+    if (mode == SamplerMode::Uniform) return counterFor(constraints).sample(rng, ships);
+    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+        if (tryFleet(constraints, rng, ships)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Placements.h"
+#include "Rng.h"
+
+//-----------// Случайные расстановки флота, согласованные с тем, что видно на поле
+
+// Положения кораблей берутся из готовых таблиц, поэтому на корабль уходит один проход
+// по таблице его длины, без повторных бросков координат.
+enum class SamplerMode {
+    Fast,       // каждый корабль - равномерно среди свободных положений (распределение немного смещено)
+    Uniform     // точно равномерно по всем допустимым расстановкам (по заранее посчитанному числу продолжений)
+};
+
+// Что известно стреляющему о поле соперника
+struct FleetConstraints {
+    Bitboard misses;    // промахи и клетки вокруг потопленных кораблей
+    Bitboard hits;      // все попадания
+    Bitboard sunk;      // потопленные корабли
+    int remaining[MAX_SHIP_LENGTH + 1];   // сколько кораблей каждой длины ещё на плаву
+};
+
+// Ограничения по видимой части поля (слой ships не читается)
+FleetConstraints constraintsFromBoard(const Board& board);
+
+// Случайная расстановка непотопленных кораблей, согласованная с ограничениями:
+// корабли накрывают все раненые клетки, не заходят на промахи и не касаются друг друга.
+// Возвращает false, если за maxAttempts попыток расставить не удалось (в точном режиме -
+// если допустимых расстановок нет).
+bool sampleFleet(const FleetConstraints& constraints, Rng& rng, Bitboard& ships,
+                 SamplerMode mode = SamplerMode::Fast, int maxAttempts = 16);
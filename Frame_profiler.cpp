@@ -0,0 +1,172 @@
+#include "Frame_profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "Allocation_counter.h"
+
+namespace {
+
+const size_t HISTORY_FRAMES = 240;      // кадров в статистике оверлея
+const size_t TRACE_SPANS = 1 << 16;     // фаз в трассе (последние несколько тысяч кадров)
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "idle", "events", "assets", "background", "text", "boards",
+    "overlay", "present", "enemy turn", "surroundSunkShips", "fillGridWithShips"
+};
+
+// Вложенные фазы уже посчитаны в объемлющих, а ожидание - не работа кадра
+bool countsTowardFrame(int phase) {
+    return phase != PHASE_IDLE && phase != PHASE_SURROUND && phase != PHASE_FLEET;
+}
+
+// Значение, которое не превышает доля fraction отсортированных значений
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}
+
+// Настройки из командной строки: --profile (оверлей сразу), --trace PATH
+ProfilerSettings parseProfilerSettings(int argc, char* argv[]) {
+    ProfilerSettings settings;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--profile") == 0) {
+            settings.overlay = true;
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            settings.tracePath = argv[++i];
+            settings.traceOnExit = true;
+        }
+    }
+    return settings;
+}
+
+FrameProfiler::FrameProfiler(const ProfilerSettings& settings)
+    : settings(settings), overlay(settings.overlay),
+      frequency(SDL_GetPerformanceFrequency()), origin(SDL_GetPerformanceCounter()) {
+    history.reserve(HISTORY_FRAMES);
+    totals.reserve(HISTORY_FRAMES);
+    spans.reserve(TRACE_SPANS);
+    lastAllocations = allocationCount();
+}
+
+void FrameProfiler::addSpan(const Span& span) {
+    if (spans.size() < TRACE_SPANS) {
+        spans.push_back(span);
+    }
+    else {
+        spans[spansNext] = span;
+        spansNext = (spansNext + 1) % TRACE_SPANS;
+    }
+}
+
+// Фаза шла от start до end (значения SDL_GetPerformanceCounter)
+void FrameProfiler::record(FramePhase phase, Uint64 start, Uint64 end) {
+    if (end < start) end = start;
+    addSpan({ start, end, phase });
+    currentMs[phase] += toMs(end - start);
+    if (countsTowardFrame(phase) && frameStart == 0) frameStart = start;
+}
+
+// Кадр показан: его фазы уходят в статистику
+void FrameProfiler::endFrame() {
+    FrameSample sample;
+    sample.totalMs = 0;
+    long long allocations = allocationCount();
+    sample.allocations = allocations - lastAllocations;
+    lastAllocations = allocations;
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        sample.phaseMs[phase] = currentMs[phase];
+        if (countsTowardFrame(phase)) sample.totalMs += currentMs[phase];
+        currentMs[phase] = 0;
+    }
+    if (history.size() < HISTORY_FRAMES) {
+        history.push_back(sample);
+    }
+    else {
+        history[historyNext] = sample;
+        historyNext = (historyNext + 1) % HISTORY_FRAMES;
+    }
+    if (frameStart != 0) addSpan({ frameStart, SDL_GetPerformanceCounter(), PHASE_COUNT });
+    frameStart = 0;
+}
+
+// Нарисовать оверлей в правом верхнем углу
+void FrameProfiler::drawOverlay(SDL_Renderer* renderer, TextAtlas& text, int screenWidth) {
+    if (!overlay || history.empty()) return;
+
+    // Оверлей сам не выделяет память, иначе он попал бы в собственный счётчик выделений
+    totals.clear();
+    double average[PHASE_COUNT] = {};
+    double peak[PHASE_COUNT] = {};
+    long long peakAllocations = 0;
+    for (const FrameSample& sample : history) {
+        totals.push_back(sample.totalMs);
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            average[phase] += sample.phaseMs[phase] / history.size();
+            peak[phase] = std::max(peak[phase], sample.phaseMs[phase]);
+        }
+        peakAllocations = std::max(peakAllocations, sample.allocations);
+    }
+    std::sort(totals.begin(), totals.end());
+    const FrameSample& last = history[(historyNext + history.size() - 1) % history.size()];
+
+    const int LINE_COUNT = PHASE_COUNT + 3;
+    char lines[LINE_COUNT][96];
+    std::snprintf(lines[0], sizeof(lines[0]), "frame ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f  (%d frames)",
+                  percentile(totals, 0.5), percentile(totals, 0.95), percentile(totals, 0.99), totals.back(),
+                  static_cast<int>(totals.size()));
+    std::snprintf(lines[1], sizeof(lines[1]), "allocations/frame  last %lld  max %lld", last.allocations, peakAllocations);
+    std::snprintf(lines[2], sizeof(lines[2]), "phase                 avg      max");
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        bool nested = !countsTowardFrame(phase);
+        std::snprintf(lines[phase + 3], sizeof(lines[phase + 3]), "%s%-*s%8.2f%9.2f", nested ? "  " : "",
+                      nested ? 16 : 18, PHASE_NAMES[phase], average[phase], peak[phase]);
+    }
+
+    int width = 0;
+    for (const char* l : lines) width = std::max(width, text.width(l));
+    int padding = 8;
+    SDL_Rect panel = { screenWidth - width - 3 * padding, padding, width + 2 * padding,
+                       LINE_COUNT * text.lineHeight() + 2 * padding };
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 192);
+    SDL_RenderFillRect(renderer, &panel);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    SDL_Color color = { 255, 255, 255, 255 };
+    int y = panel.y + padding;
+    for (const char* l : lines) {
+        text.queue(l, panel.x + padding, y, color);
+        y += text.lineHeight();
+    }
+    text.flush(renderer);
+}
+
+// Записать последние кадры как трассу Chrome; false, если файл не открылся
+bool FrameProfiler::writeTrace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << path << std::endl;
+        return false;
+    }
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n"
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main loop\"}}";
+    // Кольцо выписывается от самой старой фазы к самой новой
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const Span& span = spans[(spansNext + i) % spans.size()];
+        double start = (span.start - origin) * 1e6 / frequency;
+        double duration = (span.end - span.start) * 1e6 / frequency;
+        file << ",\n{\"name\":\"" << (span.phase == PHASE_COUNT ? "frame" : PHASE_NAMES[span.phase])
+             << "\",\"cat\":\"" << (span.phase == PHASE_COUNT ? "frame" : "phase")
+             << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << start << ",\"dur\":" << duration << "}";
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    std::cout << "Trace: " << spans.size() << " spans written to " << path << std::endl;
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include "Text_atlas.h"
+
+//-----------// Замеры фаз кадра
+
+// Таймеры вокруг фаз основного цикла. По ним рисуется оверлей (F3) с временем фаз
+// и процентилями времени кадра, а последние кадры сохраняются в формате трассы
+// Chrome (F4, открывается в chrome://tracing и ui.perfetto.dev). Оверлей показывает и число
+// выделений памяти за кадр: в установившемся режиме их быть не должно.
+enum FramePhase {
+    PHASE_IDLE,         // ожидание событий (не входит во время кадра)
+    PHASE_EVENTS,
+    PHASE_ASSETS,
+    PHASE_BACKGROUND,
+    PHASE_TEXT,
+    PHASE_BOARDS,
+    PHASE_OVERLAY,
+    PHASE_PRESENT,
+    PHASE_ENEMY,        // применение хода компьютера (сам ход считается на другом потоке)
+    PHASE_SURROUND,     // surroundSunkShips, внутри событий или хода компьютера
+    PHASE_FLEET,        // расстановка флота компьютера, внутри отрисовки полей
+    PHASE_COUNT
+};
+
+// Настройки из командной строки: --profile (оверлей сразу), --trace PATH
+struct ProfilerSettings {
+    bool overlay = false;
+    std::string tracePath = "Trace.json";
+    bool traceOnExit = false;   // --trace: записать трассу при выходе
+};
+
+ProfilerSettings parseProfilerSettings(int argc, char* argv[]);
+
+class FrameProfiler {
+public:
+    explicit FrameProfiler(const ProfilerSettings& settings);
+
+    // Фаза шла от start до end (значения SDL_GetPerformanceCounter)
+    void record(FramePhase phase, Uint64 start, Uint64 end);
+    // Кадр показан: его фазы уходят в статистику
+    void endFrame();
+    // Проход цикла закончился без кадра: полоса кадра в трассе начнётся со следующего прохода
+    void skipFrame() { frameStart = 0; }
+
+    void toggleOverlay() { overlay = !overlay; }
+    bool overlayVisible() const { return overlay; }
+    // Нарисовать оверлей в правом верхнем углу
+    void drawOverlay(SDL_Renderer* renderer, TextAtlas& text, int screenWidth);
+
+    // Записать последние кадры как трассу Chrome; false, если файл не открылся
+    bool writeTrace(const std::string& path) const;
+    const ProfilerSettings& options() const { return settings; }
+
+private:
+    struct Span {
+        Uint64 start;
+        Uint64 end;
+        int phase;      // PHASE_COUNT - весь кадр
+    };
+    struct FrameSample {
+        double phaseMs[PHASE_COUNT];
+        double totalMs;
+        long long allocations;  // вызовов operator new за кадр, во всех потоках
+    };
+
+    double toMs(Uint64 ticks) const { return ticks * 1000.0 / frequency; }
+    void addSpan(const Span& span);
+
+    ProfilerSettings settings;
+    bool overlay;
+    Uint64 frequency;
+    Uint64 origin;
+
+    // Текущий кадр
+    double currentMs[PHASE_COUNT] = {};
+    Uint64 frameStart = 0;      // 0 - в кадре ещё не было фаз
+
+    std::vector<FrameSample> history;   // кольцо последних кадров
+    size_t historyNext = 0;
+    std::vector<double> totals;         // для процентилей оверлея
+    long long lastAllocations = 0;
+    std::vector<Span> spans;            // кольцо последних фаз для трассы
+    size_t spansNext = 0;
+};
+
+// Замер фазы на время жизни объекта
+class PhaseTimer {
+public:
+    PhaseTimer(FrameProfiler& profiler, FramePhase phase)
+        : profiler(profiler), phase(phase), start(SDL_GetPerformanceCounter()) {
+    }
+    ~PhaseTimer() {
+        profiler.record(phase, start, SDL_GetPerformanceCounter());
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    FramePhase phase;
+    Uint64 start;
+};
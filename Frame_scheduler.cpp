@@ -0,0 +1,84 @@
+#include "Frame_scheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Сколько спать без событий; таймаут только страхует от потерянного пробуждения
+const int IDLE_TIMEOUT_MS = 250;
+
+// Меняет ли событие то, что на экране
+bool affectsFrame(const SDL_Event& event) {
+    switch (event.type) {
+    case SDL_QUIT:
+    case SDL_KEYDOWN:
+    case SDL_TEXTINPUT:
+    case SDL_WINDOWEVENT:
+    case SDL_RENDER_TARGETS_RESET:
+    case SDL_RENDER_DEVICE_RESET:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+// Настройки из командной строки: --vsync, --fps N
+RenderSettings parseRenderSettings(int argc, char* argv[]) {
+    RenderSettings settings;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--vsync") == 0) {
+            settings.vsync = true;
+        }
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            settings.targetFps = std::max(0, std::atoi(argv[++i]));
+        }
+    }
+    return settings;
+}
+
+FrameScheduler::FrameScheduler(const RenderSettings& settings)
+    : frameInterval(settings.targetFps > 0 ? 1000 / settings.targetFps : 0), wakeEvent(SDL_RegisterEvents(1)) {
+}
+
+// Разбудить ожидание событий из другого потока (SDL_PushEvent можно звать из любого)
+void FrameScheduler::wakeFromThread() {
+    if (wakeEvent == static_cast<Uint32>(-1)) return;
+    SDL_Event event = {};
+    event.type = wakeEvent;
+    SDL_PushEvent(&event);
+}
+
+Uint32 FrameScheduler::untilNextFrame() const {
+    Uint32 elapsed = SDL_GetTicks() - lastPresent;
+    return elapsed < frameInterval ? frameInterval - elapsed : 0;
+}
+
+bool FrameScheduler::nextEvent(SDL_Event& event) {
+    bool received;
+    if (waited) {
+        received = SDL_PollEvent(&event) != 0;
+    }
+    else {
+        waited = true;
+        Uint32 timeout = dirty ? untilNextFrame() : IDLE_TIMEOUT_MS;
+        waitBegin = SDL_GetPerformanceCounter();
+        received = timeout > 0 ? SDL_WaitEventTimeout(&event, static_cast<int>(timeout)) != 0
+                               : SDL_PollEvent(&event) != 0;
+        waitEnd = SDL_GetPerformanceCounter();
+    }
+    if (!received) return false;
+    if (affectsFrame(event) || event.type == wakeEvent) dirty = true;
+    return true;
+}
+
+bool FrameScheduler::shouldRender() const {
+    return dirty && untilNextFrame() == 0;
+}
+
+void FrameScheduler::presented() {
+    lastPresent = SDL_GetTicks();
+    dirty = false;
+}
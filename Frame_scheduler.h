@@ -0,0 +1,49 @@
+#pragma once
+#include <SDL.h>
+
+//-----------// Перерисовка только по необходимости
+
+// Кадр рисуется, только если изменилось состояние игры или пришёл ввод. Когда рисовать
+// нечего, цикл спит в SDL_WaitEventTimeout, а не крутится на полной загрузке ядра.
+struct RenderSettings {
+    bool vsync = false;     // SDL_RenderPresent ждёт вертикальную развёртку
+    int targetFps = 60;     // не больше стольких кадров в секунду; 0 - без ограничения
+};
+
+// Настройки из командной строки: --vsync, --fps N
+RenderSettings parseRenderSettings(int argc, char* argv[]);
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(const RenderSettings& settings);
+
+    // Начало прохода главного цикла: следующий nextEvent снова ждёт событие. Без этого
+    // проход, вышедший из разбора событий до их конца, оставил бы следующий без ожидания
+    void beginPass() { waited = false; }
+    // Следующее событие. Первый вызов за проход цикла ждёт: без ограничения по времени
+    // кадра, если рисовать нечего, или до времени следующего кадра, если есть что.
+    // Ввод и события окна сами помечают кадр устаревшим.
+    bool nextEvent(SDL_Event& event);
+    // Состояние игры изменилось - нужен новый кадр
+    void invalidate() { dirty = true; }
+    // Разбудить ожидание событий из другого потока (следующий кадр будет нарисован)
+    void wakeFromThread();
+    // Пора ли рисовать кадр
+    bool shouldRender() const;
+    // Кадр показан
+    void presented();
+    // Когда началось и кончилось последнее ожидание событий (SDL_GetPerformanceCounter)
+    Uint64 waitBegan() const { return waitBegin; }
+    Uint64 waitEnded() const { return waitEnd; }
+
+private:
+    Uint32 untilNextFrame() const;
+
+    Uint32 frameInterval;   // мс между кадрами, 0 - без ограничения
+    Uint32 wakeEvent;       // тип события для wakeFromThread
+    Uint32 lastPresent = 0;
+    bool dirty = true;
+    bool waited = false;    // в этом проходе цикла уже ждали событие
+    Uint64 waitBegin = 0;
+    Uint64 waitEnd = 0;
+};
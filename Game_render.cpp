@@ -0,0 +1,73 @@
+#include "Game_render.h"
+#include <algorithm>
+
+const SDL_Color VALID_PLACEMENT_COLOR = { 76, 175, 80, SDL_ALPHA_OPAQUE };     // Зелёный: корабль встанет
+const SDL_Color INVALID_PLACEMENT_COLOR = { 229, 57, 53, SDL_ALPHA_OPAQUE };   // Красный: мешают соседи
+
+// Отрисовка кораблей
+void renderShip(BoardRenderer& boards, const Ship& ship) {
+    boards.queueCells(shipMask(ship), GRID_OFFSET_X, GRID_OFFSET_Y, CELL_SIZE, CELL_SIZE + CELL_SPACING, SHIP_COLOR);
+}
+// Корабль, который сейчас ставится: зелёный, если его можно поставить, иначе красный
+void renderPlacementPreview(BoardRenderer& boards, const Ship& ship, bool valid) {
+    Bitboard cells = shipMask(ship);
+    if (cells.none()) {
+        // Корабль после поворота торчит за край поля: рисуются клетки, оставшиеся на поле
+        for (int i = 0; i < ship.length; ++i) {
+            int x = ship.x + (ship.horizontal ? i : 0);
+            int y = ship.y + (ship.horizontal ? 0 : i);
+            if (x >= 0 && y >= 0 && x < BOARD_SIZE && y < BOARD_SIZE) cells.set(cellIndex(x, y));
+        }
+    }
+    boards.queueCells(cells, GRID_OFFSET_X, GRID_OFFSET_Y, CELL_SIZE, CELL_SIZE + CELL_SPACING,
+                      valid ? VALID_PLACEMENT_COLOR : INVALID_PLACEMENT_COLOR);
+}
+// Отрисовка поля игрока
+void Player_fild_render(BoardRenderer& boards, const Board& grid) {
+    boards.queue(grid, GRID_OFFSET_X, GRID_OFFSET_Y, CELL_SIZE, CELL_SIZE + CELL_SPACING, true);
+}
+// Вспышка последнего выстрела компьютера: от белого к цвету попадания
+void renderShotFlash(BoardRenderer& boards, int cell, float fade) {
+    if (cell < 0 || cell >= CELL_COUNT) return;
+    fade = std::min(1.0f, std::max(0.0f, fade));
+    SDL_Color color = {
+        static_cast<Uint8>(255 + (HIT_COLOR.r - 255) * fade),
+        static_cast<Uint8>(255 + (HIT_COLOR.g - 255) * fade),
+        static_cast<Uint8>(255 + (HIT_COLOR.b - 255) * fade),
+        SDL_ALPHA_OPAQUE
+    };
+    Bitboard cells;
+    cells.set(cell);
+    boards.queueCells(cells, GRID_OFFSET_X, GRID_OFFSET_Y, CELL_SIZE, CELL_SIZE + CELL_SPACING, color);
+}
+
+// Стрельба по пративнику
+void renderCursor(SDL_Renderer* renderer, BoardRenderer& boards, const Board& grid, int cursorX, int cursorY) {
+    boards.queue(grid, GRID_ENEMY_OFFSET_X, GRID_OFFSET_Y, CELL_SIZE, CELL_SIZE + CELL_SPACING, false);
+    boards.flush(renderer);
+
+    // Рисуем курсор
+    int cursorXPos = GRID_ENEMY_OFFSET_X + cursorX * (CELL_SIZE + CELL_SPACING);
+    int cursorYPos = GRID_OFFSET_Y + cursorY * (CELL_SIZE + CELL_SPACING);
+    SDL_Rect cursorRect = { cursorXPos, cursorYPos, CELL_SIZE, CELL_SIZE };
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderDrawRect(renderer, &cursorRect);
+}
+// Отрисовка текста
+void TextRender(SDL_Renderer* renderer, TextAtlas& text, std::string_view line, int x, int y) {
+    SDL_Color textColor = { 0, 0, 0, 255 };
+    text.draw(renderer, line, x, y, textColor);
+}
+// Отрисовка таблицы лидеров (все строки одним вызовом)
+void LBRender(SDL_Renderer* renderer, TextAtlas& text, const std::vector<std::string>& lines) {
+    SDL_Color textColor = { 0, 0, 0, 255 };
+    int yOffset = 258;
+    int numberOfIterations = 12;
+    numberOfIterations = std::min(numberOfIterations, static_cast<int>(lines.size()));
+
+    for (int i = 0; i < numberOfIterations; ++i) {
+        text.queue(lines[i], 198, yOffset, textColor);
+        yOffset += 59;
+    }
+    text.flush(renderer);
+}
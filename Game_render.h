@@ -0,0 +1,33 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Rules.h"
+#include "Board_renderer.h"
+#include "Text_atlas.h"
+
+//-----------// Отрисовка экранов игры
+
+//Для размещения
+const int CELL_SIZE = 54;
+const int CELL_SPACING = 6;
+const int GRID_OFFSET_X = 72;
+const int GRID_ENEMY_OFFSET_X = 792;
+const int GRID_OFFSET_Y = 72;
+
+// Отрисовка кораблей
+void renderShip(BoardRenderer& boards, const Ship& ship);
+// Корабль, который сейчас ставится: зелёный, если его можно поставить, иначе красный
+void renderPlacementPreview(BoardRenderer& boards, const Ship& ship, bool valid);
+// Отрисовка поля игрока
+void Player_fild_render(BoardRenderer& boards, const Board& grid);
+// Вспышка клетки cell на поле игрока (последний выстрел компьютера); fade от 0 до 1 - как далеко угасла
+void renderShotFlash(BoardRenderer& boards, int cell, float fade);
+// Стрельба по пративнику: поле соперника и курсор
+void renderCursor(SDL_Renderer* renderer, BoardRenderer& boards, const Board& grid, int cursorX, int cursorY);
+
+// Отрисовка текста
+void TextRender(SDL_Renderer* renderer, TextAtlas& text, std::string_view line, int x, int y);
+// Отрисовка таблицы лидеров (все строки одним вызовом)
+void LBRender(SDL_Renderer* renderer, TextAtlas& text, const std::vector<std::string>& lines);
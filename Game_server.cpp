@@ -0,0 +1,648 @@
+#include "Game_server.h"
+#include <iostream>
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Hunter.h"
+#include "Replay.h"
+
+namespace {
+
+const int MAX_EVENTS = 256;
+const int ACCEPTS_PER_WAKEUP = 64;
+const int WAIT_TIMEOUT_MS = 200;
+const size_t MAX_PENDING_OUTPUT = 64 * 1024;    // клиент не читает ответы - отключаем
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+enum MatchState : uint8_t { MATCH_FREE, MATCH_PLAYING };
+
+// Партия: оба поля и кто за каким столом. players[s] - сокет стороны s или -1 (компьютер)
+struct Match {
+    Board boards[2];        // boards[s] - корабли стороны s и выстрелы по ним
+    int32_t players[2];
+    int32_t hunter;         // стратегия "hunt" этой партии в Worker::hunters или -1
+    uint8_t turn;           // чей ход
+    uint8_t ai;             // JoinMode компьютера
+    uint8_t state;
+};
+
+struct Connection {
+    uint8_t input[MESSAGE_SIZE];    // начало недочитанного сообщения
+    uint8_t inputLength = 0;
+    uint8_t side = 0;
+    bool open = false;
+    bool queued = false;            // уже в списке на отправку
+    bool waitingWrite = false;      // ждём EPOLLOUT
+    bool parking = false;           // уходит в общую очередь, дочитанное поедет с ним
+    int32_t match = -1;
+    std::vector<uint8_t> output;
+};
+
+// Счётчики потока для периодического отчёта (каждый на своей линии кэша)
+struct alignas(64) WorkerStats {
+    std::atomic<long long> connections{ 0 };
+    std::atomic<long long> matches{ 0 };
+    std::atomic<long long> moves{ 0 };
+    std::atomic<long long> games{ 0 };
+};
+
+// Человек, который ждёт соперника. Пока он ждёт, его сокет не принадлежит ни одному
+// потоку: тот, кто найдёт ему соперника, забирает сокет в свой epoll вместе с тем,
+// что уже пришло от клиента и ещё не ушло к нему
+struct ParkedPlayer {
+    int fd = -1;
+    Board fleet;
+    std::vector<uint8_t> input;     // непрочитанные байты, начиная с неполного сообщения
+    std::vector<uint8_t> output;
+};
+
+// Общая для всех потоков очередь людей: соединения разбросаны по потокам, а пары
+// должны складываться из любых двух
+class Lobby {
+public:
+    ~Lobby() {
+        if (waiting) close(parked.fd);
+    }
+
+    // Забрать ждущего в opponent, если он есть, иначе оставить ждать player. true - соперник найден
+    bool pairOrPark(ParkedPlayer& player, ParkedPlayer& opponent) {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Ждавший мог уйти, не дождавшись: такой сокет уже прочитан до конца
+        uint8_t probe;
+        if (waiting && recv(parked.fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT) == 0) {
+            close(parked.fd);
+            waiting = false;
+        }
+        if (!waiting) {
+            parked = std::move(player);
+            waiting = true;
+            return false;
+        }
+        opponent = std::move(parked);
+        parked = ParkedPlayer();
+        waiting = false;
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    bool waiting = false;
+    ParkedPlayer parked;
+};
+
+// Один поток сервера: свой epoll, свои соединения и партии
+class Worker {
+public:
+    Worker(int listener, bool tcp, uint64_t seed, WorkerStats& stats, Lobby& lobby)
+        : listener(listener), tcp(tcp), rng(seed), stats(stats), lobby(lobby) {
+    }
+
+    bool init() {
+        poller = epoll_create1(EPOLL_CLOEXEC);
+        if (poller < 0) return false;
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.fd = listener;
+        return epoll_ctl(poller, EPOLL_CTL_ADD, listener, &event) == 0;
+    }
+
+    void run() {
+        epoll_event events[MAX_EVENTS];
+        while (!stopRequested) {
+            int count = epoll_wait(poller, events, MAX_EVENTS, WAIT_TIMEOUT_MS);
+            if (count < 0 && errno != EINTR) {
+                std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == listener) {
+                    acceptClients();
+                    continue;
+                }
+                if (fd >= static_cast<int>(connections.size()) || !connections[fd].open) continue;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeConnection(fd);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) queueOutput(fd);
+                if (events[i].events & EPOLLIN) readMessages(fd);
+            }
+            flushOutput();
+        }
+        for (size_t fd = 0; fd < connections.size(); ++fd) {
+            if (connections[fd].open) close(static_cast<int>(fd));
+        }
+        close(poller);
+    }
+
+private:
+    void acceptClients() {
+        for (int i = 0; i < ACCEPTS_PER_WAKEUP; ++i) {
+            int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+                }
+                return;
+            }
+            if (tcp) {
+                int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            }
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(poller, EPOLL_CTL_ADD, fd, &event) != 0) {
+                close(fd);
+                continue;
+            }
+            openConnection(fd);
+        }
+    }
+
+    void openConnection(int fd) {
+        if (fd >= static_cast<int>(connections.size())) connections.resize(fd + 1024);
+        Connection& connection = connections[fd];
+        connection.open = true;
+        connection.parking = false;
+        connection.waitingWrite = false;
+        connection.inputLength = 0;
+        connection.match = -1;
+        connection.output.clear();
+        stats.connections.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void closeConnection(int fd) {
+        Connection& connection = connections[fd];
+        if (connection.match >= 0) {
+            Match& match = matches[connection.match];
+            int other = match.players[1 - connection.side];
+            if (match.state == MATCH_PLAYING && other >= 0) {
+                uint8_t message[MESSAGE_SIZE] = { MSG_ABORT };
+                send(other, message);
+            }
+            finishMatch(connection.match);
+        }
+        connection.open = false;
+        connection.waitingWrite = false;
+        connection.output.clear();
+        close(fd);
+        stats.connections.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Разобрать всё, что пришло; хвост неполного сообщения ждёт следующего чтения
+    void readMessages(int fd) {
+        uint8_t buffer[MESSAGE_SIZE * 64];
+        ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+        if (length <= 0) {
+            if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+            closeConnection(fd);
+            return;
+        }
+        consume(fd, buffer, static_cast<size_t>(length));
+    }
+
+    void consume(int fd, const uint8_t* buffer, size_t length) {
+        size_t position = 0;
+        while (position < length && connections[fd].open && !connections[fd].parking) {
+            Connection& connection = connections[fd];
+            size_t take = std::min<size_t>(MESSAGE_SIZE - connection.inputLength, length - position);
+            std::memcpy(connection.input + connection.inputLength, buffer + position, take);
+            connection.inputLength += static_cast<uint8_t>(take);
+            position += take;
+            if (connection.inputLength == MESSAGE_SIZE) {
+                connection.inputLength = 0;
+                handleMessage(fd, connection.input);
+            }
+        }
+        if (connections[fd].open && connections[fd].parking) park(fd, buffer + position, length - position);
+    }
+
+    void handleMessage(int fd, const uint8_t* message) {
+        if (message[0] == MSG_JOIN) handleJoin(fd, message);
+        else if (message[0] == MSG_SHOT) handleShot(fd, message[1]);
+        else sendError(fd, ERROR_BAD_MESSAGE);
+    }
+
+    void handleJoin(int fd, const uint8_t* message) {
+        if (connections[fd].match >= 0 || message[1] > JOIN_HUMAN) {
+            sendError(fd, ERROR_BAD_MESSAGE);
+            return;
+        }
+        // Нули вместо флота - расставляет сервер
+        Board own;
+        bool empty = true;
+        for (int i = 0; i < BITBOARD_BYTES; ++i) empty = empty && message[2 + i] == 0;
+        if (empty) {
+            fillGridWithShips(own, rng);
+        }
+        else {
+            own.ships = unpackBitboard(message + 2);
+            if (!isValidFleet(own.ships)) {
+                sendError(fd, ERROR_BAD_FLEET);
+                return;
+            }
+        }
+
+        // Человек уходит в общую очередь, когда дочитано всё, что от него пришло (consume)
+        if (message[1] == JOIN_HUMAN) {
+            connections[fd].parking = true;
+            parkingFleet = own;
+            return;
+        }
+
+        int id = newMatch();
+        int side = rng.below(2);
+        seat(id, side, fd, own);
+        Match& match = matches[id];
+        match.players[1 - side] = -1;
+        match.boards[1 - side] = Board();
+        fillGridWithShips(match.boards[1 - side], rng);
+        match.ai = message[1];
+        if (match.ai == JOIN_HUNT_AI) match.hunter = newHunter();
+        match.state = MATCH_PLAYING;
+        sendStart(id, side);
+        if (side == 1) playComputer(id);
+    }
+
+    void handleShot(int fd, int cell) {
+        const Connection& connection = connections[fd];
+        int id = connection.match;
+        int side = connection.side;
+        if (id < 0 || matches[id].state != MATCH_PLAYING || matches[id].turn != side) {
+            sendError(fd, ERROR_NOT_YOUR_TURN);
+            return;
+        }
+        if (cell >= CELL_COUNT || matches[id].boards[1 - side].shot().test(cell)) {
+            sendError(fd, ERROR_BAD_CELL);
+            return;
+        }
+        if (fire(id, side, cell) == SHOT_WON) return;
+        if (matches[id].players[1 - side] < 0 && matches[id].turn != side) playComputer(id);
+    }
+
+    // Отдать сокет в общую очередь; если там уже ждут, партия играется в этом потоке
+    void park(int fd, const uint8_t* rest, size_t restLength) {
+        Connection& connection = connections[fd];
+        epoll_ctl(poller, EPOLL_CTL_DEL, fd, nullptr);
+        ParkedPlayer player;
+        player.fd = fd;
+        player.fleet = parkingFleet;
+        player.input.assign(connection.input, connection.input + connection.inputLength);
+        player.input.insert(player.input.end(), rest, rest + restLength);
+        player.output.swap(connection.output);
+        connection.open = false;
+        connection.parking = false;
+        connection.waitingWrite = false;
+        connection.match = -1;
+        stats.connections.fetch_sub(1, std::memory_order_relaxed);
+
+        ParkedPlayer other;
+        if (!lobby.pairOrPark(player, other)) return;
+        // Ждавший раньше садится первым
+        int first = adopt(other);
+        int second = adopt(player);
+        if (first < 0 || second < 0) {
+            if (first >= 0) closeConnection(first);
+            if (second >= 0) closeConnection(second);
+            return;
+        }
+        int id = newMatch();
+        seat(id, 0, first, other.fleet);
+        seat(id, 1, second, player.fleet);
+        matches[id].state = MATCH_PLAYING;
+        sendStart(id, 0);
+        sendStart(id, 1);
+        consume(first, other.input.data(), other.input.size());
+        consume(second, player.input.data(), player.input.size());
+    }
+
+    // Забрать сокет из очереди в свой epoll; -1, если не вышло
+    int adopt(ParkedPlayer& player) {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = player.fd;
+        if (epoll_ctl(poller, EPOLL_CTL_ADD, player.fd, &event) != 0) {
+            close(player.fd);
+            return -1;
+        }
+        openConnection(player.fd);
+        connections[player.fd].output.swap(player.output);
+        if (!connections[player.fd].output.empty()) queueOutput(player.fd);
+        return player.fd;
+    }
+
+    // Ходы компьютера, пока он попадает
+    void playComputer(int id) {
+        int side = matches[id].players[0] < 0 ? 0 : 1;
+        while (matches[id].state == MATCH_PLAYING && matches[id].turn == side) {
+            // У "hunt" своя карта на каждую партию: она обновляется только по новым выстрелам
+            Opponent& opponent = matches[id].hunter >= 0 ? static_cast<Opponent&>(hunters[matches[id].hunter]) : randomShooter;
+            int cell = opponent.chooseShot(matches[id].boards[1 - side], rng);
+            if (fire(id, side, cell) == SHOT_WON) return;
+        }
+    }
+
+    // Выстрел стороны side по правилам игры; рассылает результат и закрывает выигранную партию
+    ShotOutcome fire(int id, int side, int cell) {
+        Match& match = matches[id];
+        Board& target = match.boards[1 - side];
+        bool hit = shootCell(target, cell);
+        surroundSunkShips(target);
+        ShotOutcome outcome = !hit ? SHOT_MISS
+                            : !CheckShip(target) ? SHOT_WON
+                            : target.sunk.test(cell) ? SHOT_SUNK : SHOT_HIT;
+        if (!hit) match.turn = static_cast<uint8_t>(1 - side);
+        stats.moves.fetch_add(1, std::memory_order_relaxed);
+
+        for (int s = 0; s < 2; ++s) {
+            if (match.players[s] < 0) continue;
+            uint8_t message[MESSAGE_SIZE] = { MSG_RESULT };
+            message[1] = s == side ? 0 : 1;
+            message[2] = static_cast<uint8_t>(cell);
+            message[3] = outcome;
+            message[4] = outcome != SHOT_WON && match.turn == s;
+            send(match.players[s], message);
+        }
+        if (outcome == SHOT_WON) {
+            stats.games.fetch_add(1, std::memory_order_relaxed);
+            finishMatch(id);
+        }
+        return outcome;
+    }
+
+    int newMatch() {
+        int id;
+        if (!freeMatches.empty()) {
+            id = freeMatches.back();
+            freeMatches.pop_back();
+        }
+        else {
+            id = static_cast<int>(matches.size());
+            matches.emplace_back();
+        }
+        Match& match = matches[id];
+        match.turn = 0;
+        match.ai = JOIN_RANDOM_AI;
+        match.hunter = -1;
+        stats.matches.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    // Чистая стратегия "hunt" для новой партии
+    int newHunter() {
+        int id;
+        if (!freeHunters.empty()) {
+            id = freeHunters.back();
+            freeHunters.pop_back();
+        }
+        else {
+            id = static_cast<int>(hunters.size());
+            hunters.emplace_back();
+        }
+        hunters[id].reset();
+        return id;
+    }
+
+    void seat(int id, int side, int fd, const Board& fleet) {
+        matches[id].boards[side] = fleet;
+        matches[id].players[side] = fd;
+        connections[fd].match = id;
+        connections[fd].side = static_cast<uint8_t>(side);
+    }
+
+    void finishMatch(int id) {
+        Match& match = matches[id];
+        for (int s = 0; s < 2; ++s) {
+            if (match.players[s] >= 0) connections[match.players[s]].match = -1;
+        }
+        if (match.hunter >= 0) freeHunters.push_back(match.hunter);
+        match.hunter = -1;
+        match.state = MATCH_FREE;
+        freeMatches.push_back(id);
+        stats.matches.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void sendStart(int id, int side) {
+        uint8_t message[MESSAGE_SIZE] = { MSG_START };
+        message[1] = static_cast<uint8_t>(side);
+        packBitboard(matches[id].boards[side].ships, message + 2);
+        send(matches[id].players[side], message);
+    }
+
+    void sendError(int fd, ErrorCode code) {
+        uint8_t message[MESSAGE_SIZE] = { MSG_ERROR };
+        message[1] = code;
+        send(fd, message);
+    }
+
+    // Ответы копятся и уходят одним вызовом на соединение в конце прохода цикла
+    void send(int fd, const uint8_t* message) {
+        Connection& connection = connections[fd];
+        connection.output.insert(connection.output.end(), message, message + MESSAGE_SIZE);
+        queueOutput(fd);
+    }
+
+    void queueOutput(int fd) {
+        if (connections[fd].queued) return;
+        connections[fd].queued = true;
+        pending.push_back(fd);
+    }
+
+    void flushOutput() {
+        // Закрытие соединения может добавить в список соперника, поэтому по индексу
+        for (size_t i = 0; i < pending.size(); ++i) {
+            int fd = pending[i];
+            Connection& connection = connections[fd];
+            connection.queued = false;
+            if (!connection.open) continue;
+            size_t sent = 0;
+            while (sent < connection.output.size()) {
+                ssize_t written = ::send(fd, connection.output.data() + sent, connection.output.size() - sent, MSG_NOSIGNAL);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                sent += written;
+            }
+            if (sent < connection.output.size() && errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeConnection(fd);
+                continue;
+            }
+            connection.output.erase(connection.output.begin(), connection.output.begin() + sent);
+            if (connection.output.size() > MAX_PENDING_OUTPUT) {
+                closeConnection(fd);
+                continue;
+            }
+            bool waitWrite = !connection.output.empty();
+            if (waitWrite != connection.waitingWrite) {
+                epoll_event event = {};
+                event.events = waitWrite ? EPOLLIN | EPOLLOUT : EPOLLIN;
+                event.data.fd = fd;
+                epoll_ctl(poller, EPOLL_CTL_MOD, fd, &event);
+                connection.waitingWrite = waitWrite;
+            }
+        }
+        pending.clear();
+    }
+
+    int listener;
+    bool tcp;
+    int poller = -1;
+    Rng rng;
+    WorkerStats& stats;
+    Lobby& lobby;
+    std::vector<Connection> connections;    // по номеру сокета
+    std::vector<Match> matches;
+    std::vector<int> freeMatches;
+    std::vector<int> pending;               // сокеты с неотправленными ответами
+    Board parkingFleet;                     // флот соединения с parking до park
+    std::vector<HuntTargetOpponent> hunters;    // по Match::hunter
+    std::vector<int> freeHunters;
+    RandomOpponent randomShooter;
+};
+
+// Разрешить столько открытых сокетов, сколько позволяет система
+void raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int openListener(const ServerOptions& options) {
+    int fd;
+    if (!options.unixPath.empty()) {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (options.unixPath.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path is too long: " << options.unixPath << std::endl;
+            close(fd);
+            return -1;
+        }
+        std::memcpy(address.sun_path, options.unixPath.c_str(), options.unixPath.size());
+        unlink(options.unixPath.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "Unable to bind " << options.unixPath << ": " << std::strerror(errno) << std::endl;
+            close(fd);
+            return -1;
+        }
+    }
+    else {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(options.port));
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "Unable to bind port " << options.port << ": " << std::strerror(errno) << std::endl;
+            close(fd);
+            return -1;
+        }
+    }
+    if (listen(fd, 4096) != 0) {
+        std::cerr << "listen failed: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+}
+
+int runGameServer(const ServerOptions& options) {
+    raiseFileLimit();
+    int listener = openListener(options);
+    if (listener < 0) return 1;
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int threads = std::max(1, options.threads);
+    std::vector<WorkerStats> stats(threads);
+    Lobby lobby;
+    std::vector<std::unique_ptr<Worker>> workers;
+    uint64_t seed = static_cast<uint64_t>(std::time(nullptr));
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(new Worker(listener, options.unixPath.empty(), seed + i * 0x9E3779B97F4A7C15ull, stats[i], lobby));
+        if (!workers.back()->init()) {
+            std::cerr << "Unable to create epoll: " << std::strerror(errno) << std::endl;
+            close(listener);
+            return 1;
+        }
+    }
+    std::vector<std::thread> running;
+    for (auto& worker : workers) running.emplace_back([&worker] { worker->run(); });
+
+    std::cout << "serving on " << (options.unixPath.empty() ? "port " + std::to_string(options.port) : options.unixPath)
+              << " with " << threads << " threads" << std::endl;
+
+    // Отчёт раз в секунду
+    long long lastMoves = 0;
+    long long lastGames = 0;
+    auto last = std::chrono::steady_clock::now();
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        if (seconds < 1) continue;
+        long long connections = 0, matches = 0, moves = 0, games = 0;
+        for (const WorkerStats& s : stats) {
+            connections += s.connections.load(std::memory_order_relaxed);
+            matches += s.matches.load(std::memory_order_relaxed);
+            moves += s.moves.load(std::memory_order_relaxed);
+            games += s.games.load(std::memory_order_relaxed);
+        }
+        std::cout << "connections " << connections << ", matches " << matches
+                  << ", moves/s " << static_cast<long long>((moves - lastMoves) / seconds)
+                  << ", games/s " << static_cast<long long>((games - lastGames) / seconds) << std::endl;
+        lastMoves = moves;
+        lastGames = games;
+        last = now;
+    }
+
+    for (std::thread& thread : running) thread.join();
+    close(listener);
+    if (!options.unixPath.empty()) unlink(options.unixPath.c_str());
+    std::cout << "server stopped" << std::endl;
+    return 0;
+}
+
+#else
+
+int runGameServer(const ServerOptions&) {
+    std::cerr << "The match server is only available on Linux" << std::endl;
+    return 1;
+}
+
+#endif
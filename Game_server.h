@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include "Net_protocol.h"
+
+//-----------// Сервер партий по сети
+
+// Партии идут по правилам из Rules.h, сервер - единственный судья. Каждый поток
+// обслуживает свои соединения в неблокирующем цикле epoll, партии лежат в общем
+// для потока массиве компактных структур фиксированного размера. Люди подбираются
+// в пары через общую для потоков очередь, так что соперник может прийти на любой поток.
+// Только Linux.
+struct ServerOptions {
+    int port = DEFAULT_PORT;
+    std::string unixPath;       // не пусто - слушать Unix-сокет вместо TCP
+    int threads = 1;
+};
+
+// Работать до SIGINT/SIGTERM; код возврата для main
+int runGameServer(const ServerOptions& options);
@@ -0,0 +1,154 @@
+#include "Hunter.h"
+
+namespace {
+
+// Диагональные соседи клеток
+Bitboard diagonalNeighbours(const Bitboard& b) {
+    Bitboard column = shiftYPlus(b) | shiftYMinus(b);
+    return shiftXPlus(column) | shiftXMinus(column);
+}
+
+}
+
+HuntTargetOpponent::HuntTargetOpponent() {
+    reset();
+}
+
+void HuntTargetOpponent::reset() {
+    blocked = Bitboard();
+    knownSunk = Bitboard();
+    for (int length = 0; length <= MAX_SHIP_LENGTH; ++length) remaining[length] = 0;
+    for (int length : FLEET) remaining[length]++;
+    for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+        const PlacementTable& table = placementTable(length);
+        for (int cell = 0; cell < CELL_COUNT; ++cell) {
+            counts[length][cell] = table.coverCount[cell];
+        }
+    }
+}
+
+int HuntTargetOpponent::heat(int cell) const {
+    int sum = 0;
+    for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+        sum += remaining[length] * counts[length][cell];
+    }
+    return sum;
+}
+
+void HuntTargetOpponent::blockCell(int cell) {
+    for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+        const PlacementTable& table = placementTable(length);
+        for (int k = 0; k < table.coverCount[cell]; ++k) {
+            const Placement& p = table.items[table.cover[cell][k]];
+            // Положение уже закрыто другим выстрелом
+            if ((p.mask & blocked).any()) continue;
+            for (int i = 0; i < length; ++i) {
+                counts[length][p.cells[i]]--;
+            }
+        }
+    }
+    blocked.set(cell);
+}
+
+void HuntTargetOpponent::sync(const Board& board) {
+    Bitboard shot = board.shot();
+    // Поле очистили - началась новая партия
+    if ((blocked & ~shot).any() || (knownSunk & ~board.sunk).any()) {
+        reset();
+    }
+
+    Bitboard fresh = shot & ~blocked;
+    while (fresh.any()) {
+        int cell = fresh.lowest();
+        fresh.reset(cell);
+        blockCell(cell);
+    }
+
+    Bitboard newSunk = board.sunk & ~knownSunk;
+    while (newSunk.any()) {
+        Bitboard ship = connectedCells(newSunk.lowest(), newSunk);
+        newSunk = newSunk & ~ship;
+        int length = ship.count();
+        if (length <= MAX_SHIP_LENGTH && remaining[length] > 0) remaining[length]--;
+    }
+    knownSunk = board.sunk;
+}
+
+int HuntTargetOpponent::huntShot(const Board& board, Rng& rng) const {
+    Bitboard freeCells = ~board.shot();
+    int best = -1;
+    int bestHeat = 0;
+    int ties = 0;
+    while (freeCells.any()) {
+        int cell = freeCells.lowest();
+        freeCells.reset(cell);
+        int h = heat(cell);
+        if (h > bestHeat) {
+            best = cell;
+            bestHeat = h;
+            ties = 1;
+        }
+        else if (h == bestHeat && h > 0 && rng.below(++ties) == 0) {
+            best = cell;
+        }
+    }
+    return best >= 0 ? best : randomFreeCell(board, rng);
+}
+
+int HuntTargetOpponent::targetShot(const Board& board, Rng& rng) const {
+    Bitboard wounded = board.hits & ~board.sunk;
+    // По диагонали от подбитой клетки корабля быть не может
+    Bitboard forbidden = board.misses | board.sunk | diagonalNeighbours(wounded);
+    Bitboard freeCells = ~board.shot();
+
+    int score[CELL_COUNT] = {};
+    for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+        if (remaining[length] == 0) continue;
+        const PlacementTable& table = placementTable(length);
+        Bitboard hits = wounded;
+        while (hits.any()) {
+            int hit = hits.lowest();
+            hits.reset(hit);
+            for (int k = 0; k < table.coverCount[hit]; ++k) {
+                const Placement& p = table.items[table.cover[hit][k]];
+                if ((p.mask & forbidden).any()) continue;
+                // Все соседние попадания должны принадлежать этому же кораблю
+                if ((p.halo & wounded & ~p.mask).any()) continue;
+                // Положение с несколькими попаданиями считаем один раз
+                if ((p.mask & wounded).lowest() != hit) continue;
+                for (int i = 0; i < length; ++i) {
+                    if (freeCells.test(p.cells[i])) score[p.cells[i]] += remaining[length];
+                }
+            }
+        }
+    }
+
+    int best = -1;
+    int bestScore = 0;
+    int bestHeat = 0;
+    int ties = 0;
+    while (freeCells.any()) {
+        int cell = freeCells.lowest();
+        freeCells.reset(cell);
+        if (score[cell] == 0) continue;
+        int h = heat(cell);
+        if (score[cell] > bestScore || (score[cell] == bestScore && h > bestHeat)) {
+            best = cell;
+            bestScore = score[cell];
+            bestHeat = h;
+            ties = 1;
+        }
+        else if (score[cell] == bestScore && h == bestHeat && rng.below(++ties) == 0) {
+            best = cell;
+        }
+    }
+    return best >= 0 ? best : huntShot(board, rng);
+}
+
+int HuntTargetOpponent::chooseShot(const Board& board, Rng& rng) {
+    sync(board);
+    if ((board.hits & ~board.sunk).any()) {
+        return targetShot(board, rng);
+    }
+    return huntShot(board, rng);
+}
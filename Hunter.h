@@ -0,0 +1,32 @@
+#pragma once
+#include "Opponent.h"
+#include "Placements.h"
+
+//-----------// Охота и добивание по карте вероятностей
+
+// Для каждой клетки считается, сколькими способами её могут накрыть оставшиеся корабли.
+// Счётчики обновляются только для положений, которые задел новый выстрел,
+// поэтому выбор хода не пересчитывает карту целиком.
+class HuntTargetOpponent : public Opponent {
+public:
+    HuntTargetOpponent();
+    const char* name() const override { return "hunt"; }
+    void reset() override;
+    int chooseShot(const Board& board, Rng& rng) override;
+    // Вес клетки на карте охоты (сумма по оставшимся кораблям)
+    int heat(int cell) const;
+
+private:
+    // Учесть выстрелы и потопленные корабли, появившиеся с прошлого хода
+    void sync(const Board& board);
+    // Закрыть все положения, проходящие через клетку
+    void blockCell(int cell);
+    int huntShot(const Board& board, Rng& rng) const;
+    int targetShot(const Board& board, Rng& rng) const;
+
+    Bitboard blocked;      // обстрелянные клетки, уже учтённые в счётчиках
+    Bitboard knownSunk;    // потопленные корабли, уже вычеркнутые из флота
+    int remaining[MAX_SHIP_LENGTH + 1];
+    // Сколько ещё открытых положений длины L накрывают клетку
+    int counts[MAX_SHIP_LENGTH + 1][CELL_COUNT];
+};
@@ -0,0 +1,217 @@
+#include "Leaderboard.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "Mapped_file.h"
+#include "Score_store.h"
+
+namespace {
+
+// Сколько записей копится в журнале до слияния с таблицей
+const int COMPACT_EVERY = 32;
+// Первая строка таблицы: номер последней слитой в неё записи журнала.
+// Одно слово без пробела не может быть строкой "имя очки"
+const char* TABLE_HEADER = "#journal:";
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Целое число из всей строки целиком
+bool parseInteger(const std::string& text, long long& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return errno == 0 && end == text.c_str() + text.size();
+}
+
+}
+
+// Разбор строки "имя очки"
+bool parseScoreLine(const std::string& line, ScoreEntry& entry) {
+    size_t end = line.size();
+    while (end > 0 && isSpace(line[end - 1])) --end;
+    size_t start = end;
+    while (start > 0 && !isSpace(line[start - 1])) --start;
+    size_t nameEnd = start;
+    while (nameEnd > 0 && isSpace(line[nameEnd - 1])) --nameEnd;
+    size_t nameStart = 0;
+    while (nameStart < nameEnd && isSpace(line[nameStart])) ++nameStart;
+    if (nameStart == nameEnd) return false;
+
+    long long score = 0;
+    if (!parseInteger(line.substr(start, end - start), score)) return false;
+    if (score < INT32_MIN || score > INT32_MAX) return false;
+    entry.name = line.substr(nameStart, nameEnd - nameStart);
+    entry.score = static_cast<int>(score);
+    return true;
+}
+
+// Прочитать таблицу и журнал; если журнал не пуст, сразу слить его в таблицу
+bool Leaderboard::open(const std::string& path) {
+    tablePath = path;
+    logPath = path + ".log";
+    entries.clear();
+    lastSequence = 0;
+    tableSequence = 0;
+    logEntries = 0;
+    if (!loadTable()) return false;
+    lastSequence = tableSequence;
+    replayLog();
+    // Слияние заодно убирает оборванный хвост журнала
+    if (logEntries > 0 || logTorn) compact();
+    return true;
+}
+
+bool Leaderboard::loadTable() {
+    std::ifstream file(tablePath);
+    if (!file.is_open()) {
+        // Таблицы ещё нет - начнём с пустой
+        std::ifstream probe(logPath);
+        if (!probe.is_open()) std::cerr << "Unable to open file: " << tablePath << std::endl;
+        return true;
+    }
+    std::string line;
+    bool first = true;
+    int skipped = 0;
+    while (std::getline(file, line)) {
+        if (first && line.compare(0, std::char_traits<char>::length(TABLE_HEADER), TABLE_HEADER) == 0) {
+            long long sequence = 0;
+            if (parseInteger(line.substr(std::char_traits<char>::length(TABLE_HEADER)), sequence) && sequence >= 0) {
+                tableSequence = static_cast<uint64_t>(sequence);
+            }
+            first = false;
+            continue;
+        }
+        first = false;
+        ScoreEntry entry;
+        if (parseScoreLine(line, entry)) {
+            entries.insert(std::make_pair(entry.score, entry.name));
+        }
+        else if (line.find_first_not_of(" \t\r") != std::string::npos) {
+            skipped++;
+        }
+    }
+    if (skipped > 0) {
+        std::cerr << "Leaderboard: skipped " << skipped << " malformed lines in " << tablePath << std::endl;
+    }
+    return true;
+}
+
+// Записи журнала: "номер имя очки". Уже слитые в таблицу и недописанные пропускаются
+void Leaderboard::replayLog() {
+    logTorn = false;
+    std::ifstream file(logPath);
+    if (!file.is_open()) return;
+    std::string line;
+    while (std::getline(file, line)) {
+        // Запись дописана, только если после неё стоит перевод строки: хвост без него -
+        // оборванная запись (например, "2 Carol 9" вместо "2 Carol 95")
+        if (file.eof()) {
+            logTorn = !line.empty();
+            break;
+        }
+        std::istringstream words(line);
+        std::string number;
+        words >> number;
+        long long sequence = 0;
+        if (!parseInteger(number, sequence) || sequence <= 0) continue;
+        ScoreEntry entry;
+        std::string rest;
+        std::getline(words, rest);
+        if (!parseScoreLine(rest, entry)) continue;
+        if (static_cast<uint64_t>(sequence) <= tableSequence) continue;
+        entries.insert(std::make_pair(entry.score, entry.name));
+        if (static_cast<uint64_t>(sequence) > lastSequence) lastSequence = sequence;
+        logEntries++;
+    }
+}
+
+// Добавить результат в память и дописать в журнал
+bool Leaderboard::add(const std::string& name, int score) {
+    entries.insert(std::make_pair(score, name));
+    lastSequence++;
+    logEntries++;
+
+    std::ofstream log(logPath, std::ios::app);
+    if (!log.is_open()) {
+        std::cerr << "Unable to open file for writing: " << logPath << std::endl;
+        return false;
+    }
+    // Хвост не убрался (слияние не удалось): последнее слово портится, чтобы хвост
+    // не стал целой записью и не склеился с новой
+    if (logTorn) log << "#\n";
+    logTorn = false;
+    log << lastSequence << " " << name << " " << score << "\n";
+    log.flush();
+    if (!log) {
+        std::cerr << "Failed to write " << logPath << std::endl;
+        return false;
+    }
+    log.close();
+
+    if (logEntries >= COMPACT_EVERY) return compact();
+    return true;
+}
+
+// Переписать таблицу целиком и очистить журнал
+bool Leaderboard::compact() {
+    std::string tempPath = tablePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Unable to open file for writing: " << tempPath << std::endl;
+            return false;
+        }
+        file << TABLE_HEADER << lastSequence << "\n";
+        for (const auto& entry : entries) {
+            file << entry.second << " " << entry.first << "\n";
+        }
+        file.flush();
+        if (!file) {
+            std::cerr << "Failed to write " << tempPath << std::endl;
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (!replaceFile(tempPath, tablePath)) {
+        std::cerr << "Failed to replace " << tablePath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    // replaceFile возвращается, когда новая таблица и её имя уже на диске, поэтому журнал
+    // можно удалять: после сбоя питания записи не пропадут вместе с ним.
+    // Таблица уже помнит номер последней записи, так что если журнал не удалится,
+    // при следующем запуске его записи просто пропустятся
+    tableSequence = lastSequence;
+    if (std::remove(logPath.c_str()) == 0) logTorn = false;
+    logEntries = 0;
+    return true;
+}
+
+// Первые count записей в виде строк "имя очки"
+std::vector<std::string> Leaderboard::top(size_t count) const {
+    std::vector<std::string> lines;
+    for (auto it = entries.begin(); it != entries.end() && lines.size() < count; ++it) {
+        lines.push_back(it->second + " " + std::to_string(it->first));
+    }
+    return lines;
+}
+
+// Таблица по имени файла: ".bin" - двоичная (ScoreStore), иначе текстовая (Leaderboard).
+// nullptr, если открыть не удалось
+std::unique_ptr<ScoreBoard> openScoreBoard(const std::string& path) {
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    if (binary) {
+        std::unique_ptr<ScoreStore> store(new ScoreStore());
+        if (!store->open(path)) return nullptr;
+        return store;
+    }
+    std::unique_ptr<Leaderboard> board(new Leaderboard());
+    if (!board->open(path)) return nullptr;
+    return board;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//-----------// Таблица лидеров
+
+// Записи держатся в памяти упорядоченными по очкам, поэтому новый результат встаёт
+// на место за O(log n) и сразу виден в первой дюжине. На диске - таблица LB.txt
+// (строки "имя очки" по убыванию) и журнал LB.txt.log, куда результаты только дописываются.
+// Время от времени журнал сливается в таблицу: она пишется во временный файл и
+// атомарно подменяет старую, так что падение посреди записи таблицу не портит.
+struct ScoreEntry {
+    std::string name;
+    int score;
+};
+
+// Разбор строки "имя очки": очки - последнее слово, имя - всё до него (может содержать
+// пробелы и цифры). false, если строка не такого вида
+bool parseScoreLine(const std::string& line, ScoreEntry& entry);
+
+// Что нужно игре от таблицы лидеров
+class ScoreBoard {
+public:
+    virtual ~ScoreBoard() = default;
+    // Запомнить результат; он сразу виден в top
+    virtual bool add(const std::string& name, int score) = 0;
+    // Первые count записей в виде строк "имя очки"
+    virtual std::vector<std::string> top(size_t count) const = 0;
+};
+
+class Leaderboard : public ScoreBoard {
+public:
+    // Прочитать таблицу и журнал; если журнал не пуст, сразу слить его в таблицу
+    bool open(const std::string& path);
+    // Добавить результат в память и дописать в журнал
+    bool add(const std::string& name, int score) override;
+    // Переписать таблицу целиком и очистить журнал
+    bool compact();
+
+    std::vector<std::string> top(size_t count) const override;
+    size_t size() const { return entries.size(); }
+
+private:
+    bool loadTable();
+    void replayLog();
+
+    std::string tablePath;
+    std::string logPath;
+    // По убыванию очков; при равенстве раньше идёт более старая запись
+    std::multimap<int, std::string, std::greater<int>> entries;
+    uint64_t lastSequence = 0;      // номер последней записи журнала
+    uint64_t tableSequence = 0;     // до какого номера журнал уже в таблице
+    int logEntries = 0;             // записей в журнале после последнего слияния
+    bool logTorn = false;           // журнал кончается оборванной записью без перевода строки
+};
+
+// Таблица по имени файла: ".bin" - двоичная (ScoreStore), иначе текстовая (Leaderboard).
+// nullptr, если открыть не удалось
+std::unique_ptr<ScoreBoard> openScoreBoard(const std::string& path);
@@ -0,0 +1,348 @@
+#include "Load_generator.h"
+#include <iostream>
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Rules.h"
+
+namespace {
+
+const int MAX_EVENTS = 256;
+const int HISTOGRAM_US = 100000;    // задержки до 100 мс с шагом в 1 мкс, дальше - в последнюю ячейку
+
+typedef std::chrono::steady_clock Clock;
+
+long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// Клиент: что он знает о поле соперника и ждёт ли ответа на выстрел
+struct Client {
+    int fd = -1;
+    Board view;                 // попадания, промахи и потопленные корабли соперника
+    uint8_t input[MESSAGE_SIZE];
+    uint8_t inputLength = 0;
+    long long shotSentNs = 0;   // 0 - ответа не ждём
+};
+
+// Результаты одного потока
+struct LoadStats {
+    std::vector<long long> histogram = std::vector<long long>(HISTOGRAM_US + 1);
+    long long maxNs = 0;
+    long long moves = 0;
+    long long games = 0;
+    long long errors = 0;
+    long long aborted = 0;
+    int connected = 0;
+};
+
+class LoadWorker {
+public:
+    LoadWorker(const LoadOptions& options, int count, uint64_t seed)
+        : options(options), count(count), rng(seed) {
+    }
+
+    bool connectAll() {
+        poller = epoll_create1(EPOLL_CLOEXEC);
+        if (poller < 0) return false;
+        clients.resize(count);
+        for (int i = 0; i < count; ++i) {
+            int fd = openConnection();
+            if (fd < 0) return false;
+            clients[i].fd = fd;
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.u32 = static_cast<uint32_t>(i);
+            epoll_ctl(poller, EPOLL_CTL_ADD, fd, &event);
+            stats.connected++;
+        }
+        return true;
+    }
+
+    void run(long long endNs) {
+        for (int i = 0; i < count; ++i) join(i);
+        epoll_event events[MAX_EVENTS];
+        while (true) {
+            long long now = nowNs();
+            if (now >= endNs) break;
+            // Выстрелы, у которых истекла пауза
+            while (!timers.empty() && timers.top().first <= now) {
+                int index = timers.top().second;
+                timers.pop();
+                shoot(index);
+            }
+            long long wakeNs = timers.empty() ? endNs : std::min(endNs, timers.top().first);
+            int timeoutMs = static_cast<int>(std::max(0ll, (wakeNs - now + 999999) / 1000000));
+            int ready = epoll_wait(poller, events, MAX_EVENTS, timeoutMs);
+            for (int i = 0; i < ready; ++i) readMessages(static_cast<int>(events[i].data.u32));
+        }
+        for (Client& client : clients) {
+            if (client.fd >= 0) close(client.fd);
+        }
+        close(poller);
+    }
+
+    const LoadStats& result() const { return stats; }
+
+private:
+    int openConnection() {
+        int fd;
+        if (!options.unixPath.empty()) {
+            fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, options.unixPath.c_str(),
+                        std::min(options.unixPath.size(), sizeof(address.sun_path) - 1));
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                std::cerr << "Unable to connect to " << options.unixPath << ": " << std::strerror(errno) << std::endl;
+                close(fd);
+                return -1;
+            }
+        }
+        else {
+            fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(options.port));
+            if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+                std::cerr << "Bad address: " << options.host << std::endl;
+                close(fd);
+                return -1;
+            }
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                std::cerr << "Unable to connect to " << options.host << ":" << options.port << ": "
+                          << std::strerror(errno) << std::endl;
+                close(fd);
+                return -1;
+            }
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+        // Подключаемся блокирующе, а дальше работаем без блокировок
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        return fd;
+    }
+
+    bool send(int index, const uint8_t* message) {
+        Client& client = clients[index];
+        if (client.fd < 0) return false;
+        // 16 байт всегда помещаются в пустой буфер сокета: клиент не шлёт следующее, не дождавшись ответа
+        if (::send(client.fd, message, MESSAGE_SIZE, MSG_NOSIGNAL) != MESSAGE_SIZE) {
+            drop(index);
+            return false;
+        }
+        return true;
+    }
+
+    void drop(int index) {
+        Client& client = clients[index];
+        if (client.fd < 0) return;
+        stats.errors++;
+        close(client.fd);
+        client.fd = -1;
+    }
+
+    void join(int index) {
+        clients[index].view = Board();
+        clients[index].shotSentNs = 0;
+        uint8_t message[MESSAGE_SIZE] = { MSG_JOIN };
+        message[1] = options.mode;
+        send(index, message);
+    }
+
+    // Свой ход: выстрел сразу или после случайной паузы
+    void scheduleShot(int index) {
+        if (options.thinkMs <= 0) {
+            shoot(index);
+            return;
+        }
+        double pause = -std::log(1.0 - rng.uniform()) * options.thinkMs * 1e6;
+        timers.push(std::make_pair(nowNs() + static_cast<long long>(pause), index));
+    }
+
+    void shoot(int index) {
+        Client& client = clients[index];
+        if (client.fd < 0) return;
+        uint8_t message[MESSAGE_SIZE] = { MSG_SHOT };
+        message[1] = static_cast<uint8_t>(randomFreeCell(client.view, rng));
+        client.shotSentNs = nowNs();
+        send(index, message);
+    }
+
+    void readMessages(int index) {
+        Client& client = clients[index];
+        if (client.fd < 0) return;
+        uint8_t buffer[MESSAGE_SIZE * 64];
+        ssize_t length = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (length <= 0) {
+            if (length < 0 && (errno == EAGAIN || errno == EINTR)) return;
+            drop(index);
+            return;
+        }
+        for (ssize_t position = 0; position < length && client.fd >= 0;) {
+            size_t take = std::min<size_t>(MESSAGE_SIZE - client.inputLength, length - position);
+            std::memcpy(client.input + client.inputLength, buffer + position, take);
+            client.inputLength += static_cast<uint8_t>(take);
+            position += take;
+            if (client.inputLength == MESSAGE_SIZE) {
+                client.inputLength = 0;
+                handleMessage(index, client.input);
+            }
+        }
+    }
+
+    void handleMessage(int index, const uint8_t* message) {
+        Client& client = clients[index];
+        switch (message[0]) {
+        case MSG_START:
+            if (message[1] == 0) scheduleShot(index);
+            break;
+        case MSG_RESULT:
+            if (message[1] == 0) {
+                record(nowNs() - client.shotSentNs);
+                client.shotSentNs = 0;
+                applyShot(client.view, message[2], message[3]);
+            }
+            if (message[3] == SHOT_WON) {
+                stats.games++;
+                join(index);
+            }
+            else if (message[4]) {
+                scheduleShot(index);
+            }
+            break;
+        case MSG_ABORT:
+            stats.aborted++;
+            join(index);
+            break;
+        default:
+            std::cerr << "server error " << static_cast<int>(message[1]) << std::endl;
+            drop(index);
+            break;
+        }
+    }
+
+    // Отметить свой выстрел на поле соперника; вокруг потопленного корабля - промахи
+    static void applyShot(Board& view, int cell, int outcome) {
+        if (outcome == SHOT_MISS) {
+            view.misses.set(cell);
+            return;
+        }
+        view.hits.set(cell);
+        if (outcome == SHOT_SUNK) {
+            Bitboard ship = connectedCells(cell, view.hits);
+            view.sunk |= ship;
+            view.misses |= dilate8(ship) & ~view.hits;
+        }
+    }
+
+    void record(long long latencyNs) {
+        stats.moves++;
+        stats.maxNs = std::max(stats.maxNs, latencyNs);
+        long long bucket = std::min<long long>(latencyNs / 1000, HISTOGRAM_US);
+        stats.histogram[bucket]++;
+    }
+
+    const LoadOptions& options;
+    int count;
+    Rng rng;
+    int poller = -1;
+    std::vector<Client> clients;
+    // Ожидающие выстрелы: время и номер клиента, ближайший сверху
+    std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>,
+                        std::greater<std::pair<long long, int>>> timers;
+    LoadStats stats;
+};
+
+// Время, которое не превысила доля fraction измерений, в микросекундах
+double percentile(const std::vector<long long>& histogram, long long total, double fraction) {
+    long long target = static_cast<long long>(std::ceil(total * fraction));
+    long long seen = 0;
+    for (size_t us = 0; us < histogram.size(); ++us) {
+        seen += histogram[us];
+        if (seen >= target) return static_cast<double>(us + 1);
+    }
+    return static_cast<double>(histogram.size());
+}
+
+}
+
+int runLoadGenerator(const LoadOptions& options) {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int threads = std::max(1, std::min(options.threads, options.connections));
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    uint64_t seed = static_cast<uint64_t>(std::time(nullptr));
+    for (int i = 0; i < threads; ++i) {
+        int share = options.connections / threads + (i < options.connections % threads ? 1 : 0);
+        workers.emplace_back(new LoadWorker(options, share, seed + i * 0x9E3779B97F4A7C15ull));
+        if (!workers.back()->connectAll()) return 1;
+    }
+    std::cout << "connected " << options.connections << " clients" << std::endl;
+
+    long long start = nowNs();
+    long long end = start + static_cast<long long>(options.seconds * 1e9);
+    std::vector<std::thread> running;
+    for (auto& worker : workers) running.emplace_back([&worker, end] { worker->run(end); });
+    for (std::thread& thread : running) thread.join();
+    double seconds = (nowNs() - start) / 1e9;
+
+    LoadStats total;
+    for (auto& worker : workers) {
+        const LoadStats& s = worker->result();
+        for (size_t i = 0; i < total.histogram.size(); ++i) total.histogram[i] += s.histogram[i];
+        total.maxNs = std::max(total.maxNs, s.maxNs);
+        total.moves += s.moves;
+        total.games += s.games;
+        total.errors += s.errors;
+        total.aborted += s.aborted;
+    }
+    std::cout << std::fixed << std::setprecision(1)
+              << "connections:     " << options.connections << " (" << threads << " threads)\n"
+              << "time:            " << seconds << " s\n"
+              << "moves:           " << total.moves << " (" << total.moves / seconds << "/s)\n"
+              << "games:           " << total.games << " (" << total.games / seconds << "/s)\n"
+              << "dropped:         " << total.errors << ", aborted games " << total.aborted << "\n";
+    if (total.moves > 0) {
+        std::cout << "latency, us:     p50 " << percentile(total.histogram, total.moves, 0.5)
+                  << ", p90 " << percentile(total.histogram, total.moves, 0.9)
+                  << ", p99 " << percentile(total.histogram, total.moves, 0.99)
+                  << ", p99.9 " << percentile(total.histogram, total.moves, 0.999)
+                  << ", max " << total.maxNs / 1000.0 << std::endl;
+    }
+    return total.errors == 0 ? 0 : 2;
+}
+
+#else
+
+int runLoadGenerator(const LoadOptions&) {
+    std::cerr << "The load generator is only available on Linux" << std::endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include "Net_protocol.h"
+
+//-----------// Нагрузочный клиент для сервера партий
+
+// Держит много соединений, каждое играет партию за партией со случайными выстрелами
+// и меряет время от выстрела до ответа сервера. Только Linux.
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    int port = DEFAULT_PORT;
+    std::string unixPath;       // не пусто - подключаться к Unix-сокету
+    int connections = 1000;
+    int threads = 1;
+    double seconds = 10;
+    double thinkMs = 100;       // средняя пауза перед выстрелом (0 - стрелять сразу)
+    JoinMode mode = JOIN_HUNT_AI;
+};
+
+int runLoadGenerator(const LoadOptions& options);
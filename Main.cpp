@@ -4,180 +4,33 @@
 #include <string>
 #include <iostream>
 #include <vector>
-#include <cstdlib>
 #include <ctime>
-#include <queue>
-#include <fstream>
 #include <algorithm>
-#include <sstream>
-#include <locale>
-#include <codecvt>
+#include <chrono>
+#include <future>
+#include <charconv>
+#include "Rules.h"
+#include "Opponent.h"
+#include "Leaderboard.h"
+#include "Replay.h"
+#include "Text_atlas.h"
+#include "Frame_scheduler.h"
+#include "Board_renderer.h"
+#include "Spectator_wall.h"
+#include "Asset_bundle.h"
+#include "Game_render.h"
+#include "Frame_profiler.h"
+#include "Ai_worker.h"
+#include "Match_snapshot.h"
+#include "Match_broadcast.h"
 
 const int WINDOW_WIDTH = 1920;
 const int WINDOW_HEIGHT = 1080;
-
-//-----------// Функции, что бы сортировать файл с таблицей лидеров
-
-struct LineData {
-    std::string text;
-    int number;
-};
-// Функция для чтения файла и получения вектора LineData
-std::vector<LineData> readFile(const std::string& filePath) {
-    std::ifstream file(filePath);
-    std::vector<LineData> lines;
-    std::string line;
-
-    if (file.is_open()) {
-
-        file.imbue(std::locale(file.getloc(), new std::codecvt_utf8<char>));
-
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string word;
-            std::string text;
-            int number;
-
-            // Извлекаем слова до последнего числа
-            while (iss >> word) {
-                if (std::isdigit(word[0])) {
-                    number = std::stoi(word);
-                    break;
-                }
-                else {
-                    if (!text.empty()) text += " ";
-                    text += word;
-                }
-            }
-            lines.push_back({ text, number });
-        }
-        file.close();
-    }
-    else {
-        std::cerr << "Unable to open file: " << filePath << std::endl;
-    }
-    return lines;
-}
-// Функция для записи вектора LineData обратно в файл
-void writeFile(const std::string& filePath, const std::vector<LineData>& lines) {
-    std::ofstream file(filePath);
-
-    if (file.is_open()) {
-
-        file.imbue(std::locale(file.getloc(), new std::codecvt_utf8<char>));
-
-        for (const auto& line : lines) {
-            file << line.text << " " << line.number << std::endl;
-        }
-        file.close();
-    }
-    else {
-        std::cerr << "Unable to open file: " << filePath << std::endl;
-    }
-}
-// Главная функция для сортировки строк в файле по числам в порядке убывания
-void sortFileByNumbersDescending(const std::string& filePath) {
-    // Чтение файла
-
-    std::vector<LineData> lines = readFile(filePath);
-
-    // Сортировка вектора по числам в порядке убывания
-    std::sort(lines.begin(), lines.end(), [](const LineData& a, const LineData& b) {
-        return b.number < a.number;
-        });
-
-    // Запись отсортированных строк обратно в файл
-    writeFile(filePath, lines);
-}
-
-//-----------// Функции, что бы сортировать файл с таблицей лидеров
-
-// Вывод двумерного массива
-void printGrid(const std::vector<std::vector<int>>& grid) {
-    for (const auto& row : grid) {
-        for (const auto& cell : row) {
-            std::cout << cell << "  ";
-        }
-        std::cout << std::endl;
-    }
-    std::cout << "--------------------------" << std::endl;
-}
-
-// Проверяет, есть ли значения от 1 до 10 вокруг группы ячеек с -2
-bool isShipAdjacent(const std::vector<std::vector<int>>& grid, const std::vector<std::pair<int, int>>& shipCells) {
-    std::vector<std::pair<int, int>> directions = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, -1}, {1, -1}, {-1, 1} };
-    for (const auto& cell : shipCells) {
-        int x = cell.first;
-        int y = cell.second;
-        for (const auto& dir : directions) {
-            int nx = x + dir.first;
-            int ny = y + dir.second;
-            if (nx >= 0 && nx < 10 && ny >= 0 && ny < 10) {
-                if (grid[nx][ny] > 0) {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
-}
-// Заполняет пустые ячейки вокруг группы ячеек с -2 значением -1
-void fillSurroundings(std::vector<std::vector<int>>& grid, const std::vector<std::pair<int, int>>& shipCells) {
-    std::vector<std::pair<int, int>> directions = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, -1}, {1, -1}, {-1, 1} };
-    for (const auto& cell : shipCells) {
-        int x = cell.first;
-        int y = cell.second;
-        for (const auto& dir : directions) {
-            int nx = x + dir.first;
-            int ny = y + dir.second;
-            if (nx >= 0 && nx < 10 && ny >= 0 && ny < 10) {
-                if (grid[nx][ny] == 0) {
-                    grid[nx][ny] = -1;
-                }
-            }
-        }
-    }
-}
-// Функция для поиска всех групп ячеек с -2 и проверки их окружения
-void surroundSunkShips(std::vector<std::vector<int>>& grid) {
-    int rows = grid.size();
-    int cols = grid[0].size();
-    std::vector<std::vector<bool>> visited(rows, std::vector<bool>(cols, false));
-    std::vector<std::pair<int, int>> directions = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
-
-    for (int x = 0; x < rows; ++x) {
-        for (int y = 0; y < cols; ++y) {
-            if (grid[x][y] == -2 && !visited[x][y]) {
-                std::vector<std::pair<int, int>> shipCells;
-                std::queue<std::pair<int, int>> q;
-                q.push({ x, y });
-                visited[x][y] = true;
-
-                while (!q.empty()) {
-                    auto cell = q.front();
-                    int cx = cell.first;
-                    int cy = cell.second;
-                    q.pop();
-                    shipCells.push_back({ cx, cy });
-
-                    for (const auto& dir : directions) {
-                        int nx = cx + dir.first;
-                        int ny = cy + dir.second;
-                        if (nx >= 0 && nx < rows && ny >= 0 && ny < cols && grid[nx][ny] == -2 && !visited[nx][ny]) {
-                            q.push({ nx, ny });
-                            visited[nx][ny] = true;
-                        }
-                    }
-                }
-
-                if (!isShipAdjacent(grid, shipCells)) {
-                    fillSurroundings(grid, shipCells);
-                }
-            }
-        }
-    }
-}
-
+const char* const REPLAY_FILE = "Replays.bin";
+// Недоигранная партия: при следующем запуске игра продолжается с того же места
+const char* const AUTOSAVE_FILE = "Autosave.bin";
+// Пауза между выстрелами компьютера после попадания (окно в это время рисуется дальше)
+const Uint32 ENEMY_PAUSE_MS = 500;
 
 // Инициализация SDL и SDL_image
 bool initSDL() {
@@ -210,8 +63,10 @@ SDL_Window* createWindow() {
     }
     return window;
 }
-SDL_Renderer* createRenderer(SDL_Window* window) {
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+SDL_Renderer* createRenderer(SDL_Window* window, bool vsync) {
+    Uint32 flags = SDL_RENDERER_ACCELERATED;
+    if (vsync) flags |= SDL_RENDERER_PRESENTVSYNC;
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, flags);
     if (renderer == nullptr) {
         std::cerr << "Failed to create renderer: " << SDL_GetError() << std::endl;
         SDL_DestroyWindow(window);
@@ -219,392 +74,68 @@ SDL_Renderer* createRenderer(SDL_Window* window) {
     }
     return renderer;
 }
-// Загрузка фонового изображения
-SDL_Texture* loadBackground(SDL_Renderer* renderer) {
-    SDL_Texture* background = IMG_LoadTexture(renderer, "BG.png");
-    if (background == nullptr) {
-        std::cerr << "Failed to load background image: " << IMG_GetError() << std::endl;
-        return nullptr;
-    }
-    return background;
-}
-// Загрузка экрана победы
-SDL_Texture* loadBackground_Win(SDL_Renderer* renderer) {
-    SDL_Texture* background_win = IMG_LoadTexture(renderer, "BG_Win.png");
-    if (background_win == nullptr) {
-        std::cerr << "Failed to load background_win image: " << IMG_GetError() << std::endl;
-        return nullptr;
-    }
-    return background_win;
-}
-// Загрузка экрана поражения
-SDL_Texture* loadBackground_Loose(SDL_Renderer* renderer) {
-    SDL_Texture* background_loose = IMG_LoadTexture(renderer, "BG_Loose.png");
-    if (background_loose == nullptr) {
-        std::cerr << "Failed to load background_loose image: " << IMG_GetError() << std::endl;
-        return nullptr;
-    }
-    return background_loose;
-}
-// Загрузка экрана лидер борда
-SDL_Texture* loadBackground_LB(SDL_Renderer* renderer) {
-    SDL_Texture* background_lb = IMG_LoadTexture(renderer, "BG_LB.png");
-    if (background_lb == nullptr) {
-        std::cerr << "Failed to load background_lb image: " << IMG_GetError() << std::endl;
-        return nullptr;
-    }
-    return background_lb;
-}
-// Загрузка экрана главного меню
-SDL_Texture* loadBackground_MM(SDL_Renderer* renderer) {
-    SDL_Texture* background_mm = IMG_LoadTexture(renderer, "MM.png");
-    if (background_mm == nullptr) {
-        std::cerr << "Failed to load background_mm image: " << IMG_GetError() << std::endl;
-        return nullptr;
-    }
-    return background_mm;
-}
-// Загрузка экрана создателя
-SDL_Texture* loadBackground_CR(SDL_Renderer* renderer) {
-    SDL_Texture* background_cr = IMG_LoadTexture(renderer, "CR.png");
-    if (background_cr == nullptr) {
-        std::cerr << "Failed to load background_cr image: " << IMG_GetError() << std::endl;
-        return nullptr;
-    }
-    return background_cr;
-}
-
-//Для размещения
-const int CELL_SIZE = 54;
-const int CELL_SPACING = 6;
-const int GRID_OFFSET_X = 72;
-const int GRID_ENEMY_OFFSET_X = 792;
-const int GRID_OFFSET_Y = 72;
-
-struct Ship {
-    int x, y, length;
-    bool horizontal;
-    Ship(int l) : x(0), y(0), length(l), horizontal(true) {}
-
-    void rotate() {
-        horizontal = !horizontal;
-    }
-};
-// Отрисовка кораблей
-void renderShip(SDL_Renderer* renderer, const Ship& ship) {
-    SDL_SetRenderDrawColor(renderer, 91, 110, 225, SDL_ALPHA_OPAQUE);
-    for (int i = 0; i < ship.length; ++i) {
-        int x = GRID_OFFSET_X + (ship.x + (ship.horizontal ? i : 0)) * (CELL_SIZE + CELL_SPACING);
-        int y = GRID_OFFSET_Y + (ship.y + (ship.horizontal ? 0 : i)) * (CELL_SIZE + CELL_SPACING);
-        SDL_Rect cell = { x, y, CELL_SIZE, CELL_SIZE };
-        SDL_RenderFillRect(renderer, &cell);
-    }
-}
-// Проверка возможности размещения корабля
-bool isValidPlacement(const Ship& ship, const std::vector<std::vector<int>>& grid) {
-    for (int i = 0; i < ship.length; ++i) {
-        int x = ship.x + (ship.horizontal ? i : 0);
-        int y = ship.y + (ship.horizontal ? 0 : i);
-        if (x < 0 || x >= 10 || y < 0 || y >= 10 || grid[x][y] != 0) return false;
-        // Проверьте окружающие ячейки на смежность
-        for (int dx = -1; dx <= 1; ++dx) {
-            for (int dy = -1; dy <= 1; ++dy) {
-                int nx = x + dx, ny = y + dy;
-                if (nx >= 0 && nx < 10 && ny >= 0 && ny < 10 && grid[nx][ny] != 0) return false;
-            }
-        }
-    }
-    return true;
-}
-// Размещение корабля
-void placeShip(Ship& ship, std::vector<std::vector<int>>& grid, int shipID) {
-    for (int i = 0; i < ship.length; ++i) {
-        int x = ship.x + (ship.horizontal ? i : 0);
-        int y = ship.y + (ship.horizontal ? 0 : i);
-        grid[x][y] = shipID;
-    }
-}
-// Заполнение поля противника
-void fillGridWithShips(std::vector<std::vector<int>>& grid) {
-    std::vector<int> shipSizes = { 4, 3, 3, 2, 2, 2, 1, 1, 1, 1 };
-    int shipID = 1;
-
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-
-    for (int size : shipSizes) {
-        bool placed = false;
-        while (!placed) {
-            Ship ship(size);
-            //ship.length = size;
-            ship.horizontal = std::rand() % 2;
-            ship.x = std::rand() % 10;
-            ship.y = std::rand() % 10;
-
-            if (isValidPlacement(ship, grid)) {
-                placeShip(ship, grid, shipID);
-                placed = true;
-                shipID++;
-            }
-        }
-    }
-}
-// Отрисовка поля игрока
-void Player_fild_render(SDL_Renderer* renderer, const std::vector<std::vector<int>>& grid) {
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-    for (int i = 0; i < 10; ++i) {
-        for (int j = 0; j < 10; ++j) {
-            int x = GRID_OFFSET_X + i * (CELL_SIZE + CELL_SPACING);
-            int y = GRID_OFFSET_Y + j * (CELL_SIZE + CELL_SPACING);
-            SDL_Rect cell = { x, y, CELL_SIZE, CELL_SIZE };
-            if (grid[i][j] == -1) {
-                SDL_SetRenderDrawColor(renderer, 135, 206, 250, SDL_ALPHA_OPAQUE); // Голубой для промаха
-            }
-            else if (grid[i][j] == -2) {
-                SDL_SetRenderDrawColor(renderer, 0, 18, 129, SDL_ALPHA_OPAQUE); // Синий для попадания
-            }
-            else if (grid[i][j] == 0) {
-                SDL_SetRenderDrawColor(renderer, 183, 180, 186, SDL_ALPHA_OPAQUE); // Для пустой клетки
-            }
-            else if (grid[i][j] > 0) {
-                SDL_SetRenderDrawColor(renderer, 91, 110, 225, SDL_ALPHA_OPAQUE); // Для целого корабля
-            }
-            SDL_RenderFillRect(renderer, &cell);
-            //SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-            //SDL_RenderDrawRect(renderer, &cell);
-        }
-    }
-}
-
-// Стрельба по пративнику
-void renderCursor(SDL_Renderer* renderer, const std::vector<std::vector<int>>& grid, int cursorX, int cursorY) {
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-    for (int i = 0; i < 10; ++i) {
-        for (int j = 0; j < 10; ++j) {
-            int x = GRID_ENEMY_OFFSET_X + i * (CELL_SIZE + CELL_SPACING);
-            int y = GRID_OFFSET_Y + j * (CELL_SIZE + CELL_SPACING);
-            SDL_Rect cell = { x, y, CELL_SIZE, CELL_SIZE };
-            if (grid[i][j] == -1) {
-                SDL_SetRenderDrawColor(renderer, 135, 206, 250, SDL_ALPHA_OPAQUE); // Голубой для промаха
-            }
-            else if (grid[i][j] == -2) {
-                SDL_SetRenderDrawColor(renderer, 0, 18, 129, SDL_ALPHA_OPAQUE); // Синий для попадания
-            }
-            else {
-                SDL_SetRenderDrawColor(renderer, 183, 180, 186, SDL_ALPHA_OPAQUE); // Для пустой клетки
-            }
-            SDL_RenderFillRect(renderer, &cell);
-            //SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-            //SDL_RenderDrawRect(renderer, &cell);
-        }
-    }
-
-    // Рисуем курсор
-    int cursorXPos = GRID_ENEMY_OFFSET_X + cursorX * (CELL_SIZE + CELL_SPACING);
-    int cursorYPos = GRID_OFFSET_Y + cursorY * (CELL_SIZE + CELL_SPACING);
-    SDL_Rect cursorRect = { cursorXPos, cursorYPos, CELL_SIZE, CELL_SIZE };
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
-    SDL_RenderDrawRect(renderer, &cursorRect);
-}
-// Выстрел играка
-bool handleShooting(std::vector<std::vector<int>>& grid, int cursorX, int cursorY) {
-    if (grid[cursorX][cursorY] > 0) {
-        grid[cursorX][cursorY] = -2; // Попадание
-        return true; 
-    }
-    else if (grid[cursorX][cursorY] == 0) {
-        grid[cursorX][cursorY] = -1; // Промах
-        return false;
-    }
-}
-// Проверка перед выстрелом играка
-bool CheckHandleShooting(std::vector<std::vector<int>>& grid, int cursorX, int cursorY) {
-    if (grid[cursorX][cursorY] == -2 || grid[cursorX][cursorY] == -1) {
-        return false;
-    }
-    else {
-        return true;
-    }
-}
-// Атака апонента
-bool EnemyAttack(std::vector<std::vector<int>>& grid) {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-
-    int rows = grid.size();
-    int cols = grid[0].size();
-
-    bool found = false;
-    while (!found) {
-        int x = std::rand() % rows;
-        int y = std::rand() % cols;
-
-        if (grid[x][y] != -1 && grid[x][y] != -2) {
-            if (grid[x][y] == 0) {
-                grid[x][y] = -1; // Промах
-                return false;
-            }
-            else if (grid[x][y] >= 1 && grid[x][y] <= 10) {
-                grid[x][y] = -2; // Попадание
-                return true;
-            }
-            found = true;
-        }
-    }
-}
-
-// Изменение счёта
-int ChangScore(std::vector<std::vector<int>>& grid, std::vector<std::vector<int>>& enemy_field) {
-    int score = 0;
-    for (int i = 0; i <= 9; i++) {
-        for (int j = 0; j <= 9; j++) {
-            if (grid[i][j] == -2) {
-                score = score - 10;
-            }
-            if (enemy_field[i][j] == -2) {
-                score = score + 10;
-            }
-        }
-    }
-    return score;
-}
-// Проверка на целые корабли
-bool CheckShip(std::vector<std::vector<int>>& grid) {
-    bool existence = false;
-    for (int i = 0; i <= 9; i++) {
-        for (int j = 0; j <= 9; j++) {
-            if (grid[i][j] > 0) {
-                existence = true;
-            }
-        }
-    }
-    return existence;
-}
-
-// Обнуления двумерного массива
-void ArrowReset(std::vector<std::vector<int>>& grid) {
-    for (int i = 0; i < 10; i++) {
-        for (int j = 0; j < 10; j++) {
-            grid[i][j] = 0;
-        }
-    }
-}
-
-// Сохранение рекорда в файл
-void saveToFile(const std::string& input, int score) {
-
-    std::ofstream outFile("LB.txt", std::ios::app);
-    if (outFile.is_open()) {
-
-        outFile << input << " " << score << "\n";
-        outFile.close();
-    }
-    else {
-        std::cerr << "Unable to open file for writing." << std::endl;
+// Отрисовка фоновой картинки (пока она грузится, экран остаётся пустым)
+void renderBackground(SDL_Renderer* renderer, SDL_Texture* background) {
+    if (background != nullptr) {
+        SDL_RenderCopy(renderer, background, nullptr, nullptr);
     }
 }
-// Загрузка значения из файла
-std::vector<std::string> loadTextFromFile(const std::string& filePath) {
-    std::vector<std::string> lines;
-    std::ifstream file(filePath);
-    if (file.is_open()) {
-        std::string line;
-        while (std::getline(file, line)) {
-            lines.push_back(line);
-        }
-        file.close();
-    }
-    else {
-        std::cerr << "Unable to open file: " << filePath << std::endl;
-    }
-    return lines;
-}
-
-// Отрисовка текста
-void TextRender(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, int x, int y) {
-    SDL_Color textColor = { 0, 0, 0, 255 };
-    SDL_Surface* textSurface = TTF_RenderUTF8_Solid(font, text.c_str(), textColor);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    int textWidth, textHeight;
-    SDL_QueryTexture(textTexture, nullptr, nullptr, &textWidth, &textHeight);
-    SDL_Rect textRect = { x, y, textWidth, textHeight };
-    SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
+// Миллисекунды с момента counter
+double millisecondsSince(Uint64 counter) {
+    return (SDL_GetPerformanceCounter() - counter) * 1000.0 / SDL_GetPerformanceFrequency();
 }
-// Отрисовка таблицы лидеров
-void LBRender(SDL_Renderer* renderer, TTF_Font* font, const std::vector<std::string>& lines) {
-    SDL_Color textColor = { 0, 0, 0, 255 };
-    int yOffset = 258;
-    int numberOfIterations = 12;
-    numberOfIterations = std::min(numberOfIterations, static_cast<int>(lines.size()));
 
-    for (int i = 0; i < numberOfIterations; ++i) {
-        SDL_Surface* textSurface = TTF_RenderUTF8_Solid(font, lines[i].c_str(), textColor);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        int textWidth, textHeight;
-        SDL_QueryTexture(textTexture, nullptr, nullptr, &textWidth, &textHeight);
-        SDL_Rect textRect;
-        textRect.x = 198;
-        textRect.y = yOffset;
-        textRect.w = textSurface->w;
-        textRect.h = textSurface->h;
-
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-
-        yOffset += 59;
-    }
+// Записать окончённую партию с именем и счётом, под которыми она попадёт в таблицу
+void saveReplay(ReplayWriter& replays, Replay& replay, const std::string& name, int score) {
+    replay.name = name;
+    replay.score = score;
+    replays.write(replay);
 }
 
 int main(int argc, char* argv[]) {
+    Uint64 startupCounter = SDL_GetPerformanceCounter();
+    RenderSettings renderSettings = parseRenderSettings(argc, argv);
     // Инициализация SDL и SDL_image
     if (!initSDL()) {
         return 1;
     }
+    // Сборка бандла картинок: Sea_Battle --pack-assets
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--pack-assets") {
+            bool packed = packAssetBundle(ASSET_BUNDLE);
+            if (packed) std::cout << "Packed " << ASSET_BUNDLE << std::endl;
+            TTF_Quit();
+            IMG_Quit();
+            SDL_Quit();
+            return packed ? 0 : 1;
+        }
+    }
     // Создание окна и рендерера
     SDL_Window* window = createWindow();
     if (window == nullptr) {
         return 1;
     }
-    SDL_Renderer* renderer = createRenderer(window);
+    SDL_Renderer* renderer = createRenderer(window, renderSettings.vsync);
     if (renderer == nullptr) {
         return 1;
     }
-    // Загрузка фонового изображения
-    SDL_Texture* background = loadBackground(renderer);
-    if (background == nullptr) {
-        return 1;
-    }
-    // Загрузка экрана победы
-    SDL_Texture* background_win = loadBackground_Win(renderer);
-    if (background_win == nullptr) {
-        return 1;
-    }
-    // Загрузка экрана поражения
-    SDL_Texture* background_loose = loadBackground_Loose(renderer);
-    if (background_loose == nullptr) {
-        return 1;
-    }
-    // Загрузка экрана лидерборда
-    SDL_Texture* background_lb = loadBackground_LB(renderer);
-    if (background_lb == nullptr) {
-        return 1;
-    }
-    // Загрузка экрана главного меню
-    SDL_Texture* background_mm = loadBackground_MM(renderer);
-    if (background_mm == nullptr) {
-        return 1;
-    }
-    // Загрузка экрана создателя
-    SDL_Texture* background_cr = loadBackground_CR(renderer);
-    if (background_cr == nullptr) {
-        return 1;
-    }
+    // Картинки раскодируются параллельно, к первому кадру нужно только главное меню
+    AssetLoader assets;
+    assets.start(ASSET_BUNDLE);
+    // Таблица лидеров: --scores PATH (файл ".bin" - двоичная таблица для больших залов).
+    // Открывается в фоне, пока грузятся картинки и шрифт
+    std::string scorePath = "LB.txt";
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--scores") scorePath = argv[i + 1];
+    }
+    std::future<std::unique_ptr<ScoreBoard>> leaderboardLoading = std::async(std::launch::async, openScoreBoard, scorePath);
+    std::unique_ptr<ScoreBoard> leaderboard;
+    std::vector<std::string> lines;
     // Инициализация SDL_ttf
     TTF_Font* font = TTF_OpenFont("Minecraft Rus NEW.otf", 48);
     if (font == nullptr) {
         std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        SDL_DestroyTexture(background);
+        assets.destroy();
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         TTF_Quit();
@@ -612,12 +143,28 @@ int main(int argc, char* argv[]) {
         SDL_Quit();
         return 1;
     }
+    // Атлас глифов шрифта для вывода текста
+    TextAtlas text;
+    if (!text.load(renderer, font)) {
+        return 1;
+    }
+    // Мелкий шрифт для оверлея замеров
+    TTF_Font* smallFont = TTF_OpenFont("Minecraft Rus NEW.otf", 20);
+    TextAtlas smallText;
+    if (smallFont == nullptr || !smallText.load(renderer, smallFont)) {
+        std::cerr << "Failed to load overlay font: " << TTF_GetError() << std::endl;
+    }
+    if (assets.wait(renderer, ASSET_MM) == nullptr) {
+        return 1;
+    }
 
     int score = 100;
     int number_of_shots = 100;
     bool Main_menu = true;
     bool Creator = false;
     bool Pause = false;
+    Uint32 pauseStart = 0;
+    int enemyLastShot = -1;
     bool Placement = false;
     bool Play = false;
     bool Player_attack = false;
@@ -630,21 +177,105 @@ int main(int argc, char* argv[]) {
     int cursorY = 0;
     std::string inputText = "";
 
-    std::string filePath = "LB.txt";
-    sortFileByNumbersDescending(filePath);
-    std::vector<std::string> lines = loadTextFromFile("LB.txt");
-
-    std::vector<Ship> ships = { Ship(4), Ship(3), Ship(3), Ship(2), Ship(2), Ship(2), Ship(1), Ship(1), Ship(1), Ship(1) };
+    Rng rng(static_cast<uint64_t>(std::time(nullptr)));
+    // Сложность противника: стратегия стрельбы компьютера
+    const char* difficultyNames[] = { "лёгкая", "обычная", "сложная" };
+    const char* difficultyOpponents[] = { "random", "hunt", "montecarlo+book+endgame" };
+    // Подписи собираются один раз, чтобы кадр не складывал строки
+    std::string difficultyLines[3];
+    for (int i = 0; i < 3; ++i) difficultyLines[i] = std::string("1/2/3 - сложность: ") + difficultyNames[i];
+    int difficulty = 1;
+    std::unique_ptr<Opponent> enemyAI = makeOpponent(difficultyOpponents[difficulty]);
+
+    // Запись партий для проверки результатов (Sea_Battle_cli replay verify)
+    ReplayWriter replays;
+    replays.open(REPLAY_FILE);
+    Replay replay;
+    // Выстрелов не бывает больше, чем клеток на двух полях: память под них выделяется один раз
+    replay.shots.reserve(2 * CELL_COUNT);
+    bool replayPending = false;     // партия окончена, но ещё не записана
+
+    std::vector<Ship> ships(std::begin(FLEET), std::end(FLEET));
     
-    std::vector<std::vector<int>> grid(10, std::vector<int>(10, 0));
-    std::vector<std::vector<int>> enemy_field(10, std::vector<int>(10, 0));
+    Board grid;
+    Board enemy_field;
+
+    // Автосохранение после каждого выстрела и поставленного корабля (копирование в память,
+    // кадр его не замечает). Снимок один на всю игру, чтобы сохранение не выделяло память
+    SnapshotFile autosave;
+    autosave.open(AUTOSAVE_FILE);
+    MatchSnapshot snapshot;
+    auto saveMatch = [&]() {
+        snapshot.phase = Placement ? MatchPhase::Placement : Enemy_attack ? MatchPhase::EnemyAttack : MatchPhase::PlayerAttack;
+        snapshot.difficulty = difficulty;
+        snapshot.boards[0] = grid;
+        snapshot.boards[1] = enemy_field;
+        for (int i = 0; i < FLEET_SIZE; ++i) snapshot.ships[i] = { ships[i].x, ships[i].y, ships[i].horizontal };
+        snapshot.currentShip = currentShip;
+        snapshot.cursorX = cursorX;
+        snapshot.cursorY = cursorY;
+        snapshot.score = score;
+        snapshot.shotsLeft = number_of_shots;
+        snapshot.rng = rng.state;
+        snapshot.replaySeed = replay.seed;
+        snapshot.shotCount = static_cast<int>(replay.shots.size());
+        std::copy(replay.shots.begin(), replay.shots.end(), snapshot.shots);
+        autosave.save(snapshot);
+    };
+    // Выстрелы партии для оверлеев и зрителей в других процессах (Sea_Battle_cli watch)
+    BroadcastPublisher broadcast;
+    broadcast.open(BROADCAST_NAME);
+    // Продолжение партии, прерванной в прошлый раз
+    if (autosave.load(snapshot)) {
+        Main_menu = false;
+        Placement = snapshot.phase == MatchPhase::Placement;
+        Play = !Placement;
+        Player_attack = snapshot.phase == MatchPhase::PlayerAttack;
+        Enemy_attack = snapshot.phase == MatchPhase::EnemyAttack;
+        if (snapshot.difficulty != difficulty) {
+            difficulty = snapshot.difficulty;
+            enemyAI = makeOpponent(difficultyOpponents[difficulty]);
+        }
+        grid = snapshot.boards[0];
+        enemy_field = snapshot.boards[1];
+        for (int i = 0; i < FLEET_SIZE; ++i) {
+            ships[i].x = snapshot.ships[i].x;
+            ships[i].y = snapshot.ships[i].y;
+            ships[i].horizontal = snapshot.ships[i].horizontal;
+        }
+        currentShip = snapshot.currentShip;
+        cursorX = snapshot.cursorX;
+        cursorY = snapshot.cursorY;
+        score = snapshot.score;
+        number_of_shots = snapshot.shotsLeft;
+        rng.state = snapshot.rng;
+        replay.seed = snapshot.replaySeed;
+        replay.fleets[0] = grid.ships;
+        replay.fleets[1] = enemy_field.ships;
+        replay.shots.assign(snapshot.shots, snapshot.shots + snapshot.shotCount);
+        if (Play) broadcast.startMatch(score);
+    }
 
     // Основной игровой цикл
+    FrameScheduler scheduler(renderSettings);
+    // Замеры фаз кадра: F3 - оверлей, F4 - записать трассу
+    FrameProfiler profiler(parseProfilerSettings(argc, argv));
+    // Ходы компьютера считаются на своём потоке; готовый ход будит цикл событий
+    AiWorker aiWorker([&scheduler]() { scheduler.wakeFromThread(); });
+    BoardRenderer boards;
+    bool firstFrameShown = false;
     bool running = true;
+    // Режим зрителя: стена партий вместо игры
+    WallOptions wall = parseWallOptions(argc, argv);
+    if (wall.games > 0) {
+        runSpectatorWall(renderer, text, wall, renderSettings);
+        running = false;
+    }
     while (running) {
-        // Обработка событий
+        scheduler.beginPass();
+        // Обработка событий (ждём их, пока перерисовывать нечего)
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
+        while (scheduler.nextEvent(event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
             }
@@ -655,20 +286,26 @@ int main(int argc, char* argv[]) {
                 if (event.key.keysym.sym == SDLK_ESCAPE) {
                     running = false;
                 }
+                if (event.key.keysym.sym == SDLK_F3) {
+                    profiler.toggleOverlay();
+                }
+                if (event.key.keysym.sym == SDLK_F4) {
+                    profiler.writeTrace(profiler.options().tracePath);
+                }
                 if (Placement) {
                     switch (event.key.keysym.sym) {
                     case SDLK_w:
                         if (ships[currentShip].y > 0) ships[currentShip].y--;
                         break;
                     case SDLK_s:
-                        if (ships[currentShip].horizontal && ships[currentShip].y < 9 || !ships[currentShip].horizontal && ships[currentShip].y < 10 - ships[currentShip].length)
+                        if ((ships[currentShip].horizontal && ships[currentShip].y < BOARD_SIZE - 1) || (!ships[currentShip].horizontal && ships[currentShip].y < BOARD_SIZE - ships[currentShip].length))
                             ships[currentShip].y++;
                         break;
                     case SDLK_a:
                         if (ships[currentShip].x > 0) ships[currentShip].x--;
                         break;
                     case SDLK_d:
-                        if (ships[currentShip].horizontal && ships[currentShip].x < 10 - ships[currentShip].length || !ships[currentShip].horizontal && ships[currentShip].x < 9)
+                        if ((ships[currentShip].horizontal && ships[currentShip].x < BOARD_SIZE - ships[currentShip].length) || (!ships[currentShip].horizontal && ships[currentShip].x < BOARD_SIZE - 1))
                             ships[currentShip].x++;
                         break;
                     case SDLK_r:
@@ -676,8 +313,9 @@ int main(int argc, char* argv[]) {
                         break;
                     case SDLK_RETURN:
                         if (isValidPlacement(ships[currentShip], grid)) {
-                            placeShip(ships[currentShip], grid, currentShip + 1);
+                            placeShip(ships[currentShip], grid);
                             currentShip++;
+                            saveMatch();
                         }
                         //printGrid(grid);
                     }
@@ -688,17 +326,21 @@ int main(int argc, char* argv[]) {
                         if (cursorY > 0) cursorY--;
                         break;
                     case SDLK_s:
-                        if (cursorY < 9) cursorY++;
+                        if (cursorY < BOARD_SIZE - 1) cursorY++;
                         break;
                     case SDLK_a:
                         if (cursorX > 0) cursorX--;
                         break;
                     case SDLK_d:
-                        if (cursorX < 9) cursorX++;
+                        if (cursorX < BOARD_SIZE - 1) cursorX++;
                         break;
                     case SDLK_RETURN:
                         if (CheckHandleShooting(enemy_field, cursorX, cursorY)) {
+                            replay.shots.push_back(static_cast<uint8_t>(cellIndex(cursorX, cursorY)));
+                            Bitboard sunkBefore = enemy_field.sunk;
                             if (handleShooting(enemy_field, cursorX, cursorY)) {
+                                PhaseTimer timer(profiler, PHASE_SURROUND);
+                                surroundSunkShips(enemy_field);
                                 //printGrid(enemy_field);
                             }
                             else {
@@ -708,12 +350,18 @@ int main(int argc, char* argv[]) {
                             }
                             number_of_shots--;
                             score = number_of_shots + ChangScore(grid, enemy_field);
+                            broadcast.publish(shotDelta(0, cellIndex(cursorX, cursorY), enemy_field, sunkBefore, score));
                             if (CheckShip(enemy_field) == false) {
                                 Win = true;
                                 Play = false;
                                 Player_attack = false;
                                 Enemy_attack = false;
                                 inputText = "";
+                                replayPending = true;
+                                autosave.clear();
+                            }
+                            else {
+                                saveMatch();
                             }
                         }
                         break;
@@ -724,8 +372,17 @@ int main(int argc, char* argv[]) {
                         inputText.pop_back();
                     }
                     else if (event.key.keysym.sym == SDLK_RETURN) {
-                        if (inputText.length() >= 2) {
-                            saveToFile(inputText, score);
+                        if (leaderboardLoading.valid()) {
+                            leaderboard = leaderboardLoading.get();
+                            if (leaderboard) lines = leaderboard->top(12);
+                        }
+                        if (inputText.length() >= 2 && leaderboard) {
+                            if (replayPending) {
+                                saveReplay(replays, replay, inputText, score);
+                                replayPending = false;
+                            }
+                            leaderboard->add(inputText, score);
+                            lines = leaderboard->top(12);
                             inputText = "";
                         }
                     }
@@ -733,6 +390,10 @@ int main(int argc, char* argv[]) {
                         showText = !showText;
                     }
                     if (event.key.keysym.sym == SDLK_LCTRL || event.key.keysym.sym == SDLK_RCTRL) {
+                        if (replayPending) {
+                            saveReplay(replays, replay, "", score);
+                            replayPending = false;
+                        }
                         score = 100;
                         number_of_shots = 100;
                         Pause = false;
@@ -747,9 +408,11 @@ int main(int argc, char* argv[]) {
                         cursorY = 0;
                         ArrowReset(grid);
                         ArrowReset(enemy_field);
+                        aiWorker.discard();
+                        enemyAI->reset();
                         //printGrid(grid);
                         //printGrid(enemy_field);
-                        for (int i = 0; i < 10; i++) {
+                        for (int i = 0; i < FLEET_SIZE; i++) {
                             ships[i].y = 0;
                             ships[i].x = 0;
                             if (ships[i].horizontal == false) {
@@ -772,6 +435,11 @@ int main(int argc, char* argv[]) {
                     if (event.key.keysym.sym == SDLK_TAB) {
                         showText = !showText;
                     }
+                    if (event.key.keysym.sym >= SDLK_1 && event.key.keysym.sym <= SDLK_3) {
+                        difficulty = event.key.keysym.sym - SDLK_1;
+                        aiWorker.discard();
+                        enemyAI = makeOpponent(difficultyOpponents[difficulty]);
+                    }
                 }
                 if (Creator) {
                     if (event.key.keysym.sym == SDLK_LCTRL || event.key.keysym.sym == SDLK_RCTRL) {
@@ -782,91 +450,182 @@ int main(int argc, char* argv[]) {
                 }
             }
         }
+        profiler.record(PHASE_IDLE, scheduler.waitBegan(), scheduler.waitEnded());
+        profiler.record(PHASE_EVENTS, scheduler.waitEnded(), SDL_GetPerformanceCounter());
+        // Картинки и таблица лидеров, догрузившиеся в фоне
+        bool assetFailed = false;
+        {
+            PhaseTimer timer(profiler, PHASE_ASSETS);
+            if (!assets.complete() && assets.poll(renderer, assetFailed) > 0) {
+                scheduler.invalidate();
+                if (assets.complete()) {
+                    std::cout << "Startup: all images after " << millisecondsSince(startupCounter) << " ms ("
+                              << (assets.fromBundle() ? ASSET_BUNDLE : "PNG") << ")" << std::endl;
+                }
+            }
+            if (leaderboardLoading.valid() && leaderboardLoading.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                leaderboard = leaderboardLoading.get();
+                if (leaderboard) lines = leaderboard->top(12);
+                scheduler.invalidate();
+            }
+        }
+        if (assetFailed) {
+            running = false;
+        }
+        // Атака опанента: выстрел выбирается на рабочем потоке, цикл его не ждёт
+        if (Pause) {
+            if (SDL_GetTicks() - pauseStart >= ENEMY_PAUSE_MS) Pause = false;
+            scheduler.invalidate();     // кадры вспышки последнего выстрела
+        }
+        if (Enemy_attack && !Pause && !aiWorker.busy()) {
+            aiWorker.request(*enemyAI, grid, rng);
+        }
+        AiMove enemyMove;
+        if (aiWorker.poll(enemyMove)) {
+            PhaseTimer timer(profiler, PHASE_ENEMY);
+            rng = enemyMove.rng;
+            int cell = enemyMove.cell;
+            replay.shots.push_back(static_cast<uint8_t>(cell));
+            Bitboard sunkBefore = grid.sunk;
+            bool hit = shootCell(grid, cell);
+            {
+                PhaseTimer surroundTimer(profiler, PHASE_SURROUND);
+                surroundSunkShips(grid);
+            }
+            if (hit) {
+                Pause = true;
+                pauseStart = SDL_GetTicks();
+                enemyLastShot = cell;
+            }
+            else {
+                Player_attack = true;
+                Enemy_attack = false;
+            }
+            scheduler.invalidate();
+            score = number_of_shots + ChangScore(grid, enemy_field);
+            broadcast.publish(shotDelta(1, cell, grid, sunkBefore, score));
+            if (CheckShip(grid) == false) {
+                Loose = true;
+                Play = false;
+                Player_attack = false;
+                Enemy_attack = false;
+                inputText = "";
+                replayPending = true;
+                autosave.clear();
+            }
+            else {
+                saveMatch();
+            }
+        }
+        // Ничего не изменилось или рано для следующего кадра. Полоса кадра в трассе
+        // не должна тянуться через ожидания прошлых проходов
+        if (!scheduler.shouldRender()) {
+            profiler.skipFrame();
+            continue;
+        }
         // Очистка экрана
+        Uint64 backgroundStart = SDL_GetPerformanceCounter();
         SDL_RenderClear(renderer);
 
         // Отрисовка фонового изображения
         {
             if (Win) {
-                SDL_RenderCopy(renderer, background_win, nullptr, nullptr);
+                renderBackground(renderer, assets.texture(ASSET_WIN));
                 //std::cout << "Win" << std::endl;
             }
             else if (Loose) {
-                SDL_RenderCopy(renderer, background_loose, nullptr, nullptr);
+                renderBackground(renderer, assets.texture(ASSET_LOOSE));
                 //std::cout << "Loose" << std::endl;
             }
             else if (Main_menu) {
-                SDL_RenderCopy(renderer, background_mm, nullptr, nullptr);
+                renderBackground(renderer, assets.texture(ASSET_MM));
                 //std::cout << "Main_menu" << std::endl;
             }
             else if (Creator) {
-                SDL_RenderCopy(renderer, background_cr, nullptr, nullptr);
+                renderBackground(renderer, assets.texture(ASSET_CR));
                 //std::cout << "Creator" << std::endl;
             }
             else {
-                SDL_RenderCopy(renderer, background, nullptr, nullptr);
+                renderBackground(renderer, assets.texture(ASSET_BG));
                 //std::cout << "Play" << std::endl;
             }
         }
-        
+        Uint64 textStart = SDL_GetPerformanceCounter();
+        profiler.record(PHASE_BACKGROUND, backgroundStart, textStart);
+
+        // Счёт строкой без выделения памяти
+        char scoreBuffer[16];
+        std::string_view scoreText(scoreBuffer, std::to_chars(scoreBuffer, scoreBuffer + sizeof(scoreBuffer), score).ptr - scoreBuffer);
+        // Выбор сложности в главном меню
+        if (Main_menu == true) {
+            TextRender(renderer, text, difficultyLines[difficulty], 66, 990);
+        }
         // Вывод текста при размещении
         if (Placement == true)
         {
-            TextRender(renderer, font, "w/a/s/d - передвижение", 66, 726);
-            TextRender(renderer, font, "r - поворот", 66, 798);
-            TextRender(renderer, font, "Enter - разместить", 66, 870);
+            TextRender(renderer, text, "w/a/s/d - передвижение", 66, 726);
+            TextRender(renderer, text, "r - поворот", 66, 798);
+            TextRender(renderer, text, "Enter - разместить", 66, 870);
+            // Сколько мест осталось для текущего корабля (проверка по готовым таблицам, на каждом кадре)
+            if (currentShip < static_cast<int>(ships.size())) {
+                char freeBuffer[48] = "свободных мест: ";
+                size_t prefix = std::char_traits<char>::length(freeBuffer);
+                char* end = std::to_chars(freeBuffer + prefix, freeBuffer + sizeof(freeBuffer), countValidPlacements(ships[currentShip].length, grid)).ptr;
+                TextRender(renderer, text, std::string_view(freeBuffer, end - freeBuffer), 66, 942);
+            }
         }
         // Отрисовка счёта при игре
         if (Play == true) {
-            TextRender(renderer, font, std::to_string(score).c_str(), WINDOW_WIDTH - 450, 198);
+            TextRender(renderer, text, scoreText, WINDOW_WIDTH - 450, 198);
         }
         // Вывод текста при игре
         if (Play == true)
         {
-            TextRender(renderer, font, "w/a/s/d - передвижение", 66, 726);
-            TextRender(renderer, font, "Enter - выстрел", 66, 798);
+            TextRender(renderer, text, "w/a/s/d - передвижение", 66, 726);
+            TextRender(renderer, text, "Enter - выстрел", 66, 798);
         }
         // Отрисовка счёта при выигрыше
         if (Win == true) {
-            TextRender(renderer, font, std::to_string(score).c_str(), 582, 594);
+            TextRender(renderer, text, scoreText, 582, 594);
         }
         // Отрисовка счёта при проигрыше
         if (Loose == true) {
-            TextRender(renderer, font, std::to_string(score).c_str(), 306, 594);
+            TextRender(renderer, text, scoreText, 306, 594);
         }
         // Отрисовка имени при выигрыше
         if (Win == true) {
-            TextRender(renderer, font, inputText.c_str(), 792, 666);
+            TextRender(renderer, text, inputText, 792, 666);
         }
         // Отрисовка имени при проигрыше
         if (Loose == true) {
-            TextRender(renderer, font, inputText.c_str(), 522, 666);
+            TextRender(renderer, text, inputText, 522, 666);
         }
         // Отрисовка лидер борда
         if (showText == true) {
-            SDL_RenderCopy(renderer, background_lb, nullptr, nullptr);
-            LBRender(renderer, font, lines);
+            renderBackground(renderer, assets.texture(ASSET_LB));
+            LBRender(renderer, text, lines);
         }
         // Отрисовка о себе
         if (Creator == true)
         {
-            TextRender(renderer, font, "А я не знаю, что тут писать. Как будто я буду", 240, 540);
-            TextRender(renderer, font, "это выкладывать куда-нибудь.", 240, 595);
-            TextRender(renderer, font, "Ну ник могу написать: Nix_Afax", 240, 650);
-            TextRender(renderer, font, "Я ващето позицианирую себя как", 240, 705);
-            TextRender(renderer, font, "моушен дизайнера.", 240, 760);
+            TextRender(renderer, text, "А я не знаю, что тут писать. Как будто я буду", 240, 540);
+            TextRender(renderer, text, "это выкладывать куда-нибудь.", 240, 595);
+            TextRender(renderer, text, "Ну ник могу написать: Nix_Afax", 240, 650);
+            TextRender(renderer, text, "Я ващето позицианирую себя как", 240, 705);
+            TextRender(renderer, text, "моушен дизайнера.", 240, 760);
         }
-
+        Uint64 boardsStart = SDL_GetPerformanceCounter();
+        profiler.record(PHASE_TEXT, textStart, boardsStart);
 
         // Рендер размещённых кораблей
         if (Placement) {
             for (int i = 0; i < currentShip; ++i) {
-                renderShip(renderer, ships[i]);
+                renderShip(boards, ships[i]);
             }
         }
-        // Рендер кораблей, которые щас размещаются
+        // Рендер корабля, который щас размещается: цвет показывает, встанет ли он
         if (currentShip < ships.size() && Placement) {
-            renderShip(renderer, ships[currentShip]);
+            renderPlacementPreview(boards, ships[currentShip], isValidPlacement(ships[currentShip], grid));
         }
         // Изменение статуса
         else if(Placement == true)
@@ -874,47 +633,67 @@ int main(int argc, char* argv[]) {
             Placement = false;
             Play = true;
             Player_attack = true;
-            fillGridWithShips(enemy_field);
+            // Поля сбрасываются по одному: новый Replay выбросил бы память под выстрелы
+            replay.name.clear();
+            replay.score = 0;
+            replay.shots.clear();
+            replay.seed = rng.state;
+            {
+                PhaseTimer timer(profiler, PHASE_FLEET);
+                fillGridWithShips(enemy_field, rng);
+            }
+            replay.fleets[0] = grid.ships;
+            replay.fleets[1] = enemy_field.ships;
+            saveMatch();
+            broadcast.startMatch(score);
+            scheduler.invalidate();
             //printGrid(enemy_field);
         }
         // Рендер во время игры
         else if (Play == true) {
-            renderCursor(renderer, enemy_field, cursorX, cursorY);
-            surroundSunkShips(enemy_field);
-            Player_fild_render(renderer, grid);
+            Player_fild_render(boards, grid);
+            if (Pause) {
+                renderShotFlash(boards, enemyLastShot, static_cast<float>(SDL_GetTicks() - pauseStart) / ENEMY_PAUSE_MS);
+            }
+            renderCursor(renderer, boards, enemy_field, cursorX, cursorY);
+        }
+        boards.flush(renderer);
+        profiler.record(PHASE_BOARDS, boardsStart, SDL_GetPerformanceCounter());
+        {
+            PhaseTimer timer(profiler, PHASE_OVERLAY);
+            profiler.drawOverlay(renderer, smallText, WINDOW_WIDTH);
         }
-        
-        // Обновление экрана
-        SDL_RenderPresent(renderer);
 
-        // Атака опанента
-        if (Pause) {
-            SDL_Delay(500);
-            Pause = false;
+        // Обновление экрана
+        {
+            PhaseTimer timer(profiler, PHASE_PRESENT);
+            SDL_RenderPresent(renderer);
         }
-        if (Enemy_attack) {
-            if (EnemyAttack(grid)) {
-                surroundSunkShips(grid);
-                Pause = true;
-            }
-            else {
-                surroundSunkShips(grid);
-                Player_attack = true;
-                Enemy_attack = false;
-            }
-            score = number_of_shots + ChangScore(grid, enemy_field);
-            if (CheckShip(grid) == false) {
-                Loose = true;
-                Play = false;
-                Player_attack = false;
-                Enemy_attack = false;
-                inputText = "";
-            }
+        scheduler.presented();
+        if (!firstFrameShown) {
+            firstFrameShown = true;
+            std::cout << "Startup: first frame after " << millisecondsSince(startupCounter) << " ms" << std::endl;
         }
+
+        profiler.endFrame();
+    }
+
+    // Недосчитанный ход компьютера дожидается здесь: после SDL_Quit будить цикл уже нельзя
+    aiWorker.discard();
+    if (profiler.options().traceOnExit) {
+        profiler.writeTrace(profiler.options().tracePath);
+    }
+    // Доигранная, но не сохранённая партия
+    if (replayPending) {
+        saveReplay(replays, replay, "", score);
     }
 
     // Очистка ресурсов
-    SDL_DestroyTexture(background);
+    text.destroy();
+    smallText.destroy();
+    TTF_CloseFont(font);
+    if (smallFont != nullptr) TTF_CloseFont(smallFont);
+    assets.destroy();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     IMG_Quit();
@@ -0,0 +1,183 @@
+#include "Mapped_file.h"
+#include <cstdio>
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+// Только чтение
+bool MappedFile::openRead(const std::string& path) {
+    return open(path, false, 0);
+}
+
+// Чтение и запись; файл создаётся и дополняется нулями до minSize байт
+bool MappedFile::openWrite(const std::string& path, size_t minSize) {
+    return open(path, true, minSize);
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, bool write, size_t minSize) {
+    close();
+    HANDLE handle = CreateFileA(path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                                FILE_SHARE_READ, nullptr, write ? OPEN_ALWAYS : OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        std::cerr << "Unable to open file: " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        return false;
+    }
+    size_t size = static_cast<size_t>(fileSize.QuadPart);
+    if (size < minSize) size = minSize;
+    file = handle;
+    writable = write;
+    opened = true;
+    length = size;
+    if (size == 0) return true;
+
+    // Отображение размером больше файла само дописывает файл нулями
+    uint64_t wide = size;
+    mapping = CreateFileMappingA(handle, nullptr, write ? PAGE_READWRITE : PAGE_READONLY,
+                                 static_cast<DWORD>(wide >> 32), static_cast<DWORD>(wide), nullptr);
+    if (mapping != nullptr) {
+        view = static_cast<unsigned char*>(MapViewOfFile(mapping, write ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size));
+    }
+    if (view == nullptr) {
+        std::cerr << "Unable to map file: " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (view != nullptr) UnmapViewOfFile(view);
+    if (mapping != nullptr) CloseHandle(mapping);
+    if (file != nullptr) CloseHandle(file);
+    view = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    length = 0;
+    writable = false;
+    opened = false;
+}
+
+bool MappedFile::flush() {
+    if (view == nullptr || !writable) return true;
+    return FlushViewOfFile(view, 0) != 0 && FlushFileBuffers(file) != 0;
+}
+
+// Заменить файл target файлом source одним действием
+bool replaceFile(const std::string& source, const std::string& target) {
+    // Содержимое должно оказаться на диске раньше нового имени, иначе после сбоя
+    // под именем target может остаться пустой файл
+    HANDLE handle = CreateFileA(source.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    bool flushed = FlushFileBuffers(handle) != 0;
+    CloseHandle(handle);
+    if (!flushed) return false;
+    // MOVEFILE_WRITE_THROUGH возвращается только после записи переименования на диск
+    return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, bool write, size_t minSize) {
+    close();
+    int fd = ::open(path.c_str(), write ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0) {
+        std::cerr << "Unable to open file: " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    if (write && size < minSize) {
+        if (ftruncate(fd, static_cast<off_t>(minSize)) != 0) {
+            std::cerr << "Unable to resize file: " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        size = minSize;
+    }
+    descriptor = fd;
+    writable = write;
+    opened = true;
+    length = size;
+    if (size == 0) return true;
+
+    void* address = mmap(nullptr, size, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        std::cerr << "Unable to map file: " << path << std::endl;
+        close();
+        return false;
+    }
+    view = static_cast<unsigned char*>(address);
+    return true;
+}
+
+void MappedFile::close() {
+    if (view != nullptr) munmap(view, length);
+    if (descriptor >= 0) ::close(descriptor);
+    view = nullptr;
+    descriptor = -1;
+    length = 0;
+    writable = false;
+    opened = false;
+}
+
+bool MappedFile::flush() {
+    if (view == nullptr || !writable) return true;
+    return msync(view, length, MS_SYNC) == 0;
+}
+
+namespace {
+
+// Сбросить на диск файл или каталог по пути
+bool syncPath(const std::string& path, int flags) {
+    int fd = ::open(path.c_str(), flags);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+// Каталог, в котором лежит файл
+std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) return ".";
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+}
+
+// Заменить файл target файлом source одним действием
+bool replaceFile(const std::string& source, const std::string& target) {
+    // Содержимое должно оказаться на диске раньше нового имени, иначе после сбоя
+    // под именем target может остаться пустой файл
+    if (!syncPath(source, O_RDONLY)) return false;
+    if (std::rename(source.c_str(), target.c_str()) != 0) return false;
+    // Само переименование записано в каталоге и переживёт сбой только после его fsync
+    return syncPath(directoryOf(target), O_RDONLY | O_DIRECTORY);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//-----------// Файл, отображённый в память
+
+// Страницы подгружаются системой по мере обращения, поэтому открытие большого файла
+// не читает его целиком, а в памяти остаётся только то, к чему обращались.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Только чтение. Пустой файл открывается с size() == 0
+    bool openRead(const std::string& path);
+    // Чтение и запись; файл создаётся и дополняется нулями до minSize байт
+    bool openWrite(const std::string& path, size_t minSize);
+    void close();
+    // Сбросить изменённые страницы на диск
+    bool flush();
+
+    bool isOpen() const { return opened; }
+    const unsigned char* data() const { return view; }
+    unsigned char* data() { return writable ? view : nullptr; }
+    size_t size() const { return length; }
+
+private:
+    bool open(const std::string& path, bool write, size_t minSize);
+
+    unsigned char* view = nullptr;
+    size_t length = 0;
+    bool writable = false;
+    bool opened = false;
+#ifdef _WIN32
+    void* file = nullptr;       // HANDLE
+    void* mapping = nullptr;    // HANDLE
+#else
+    int descriptor = -1;
+#endif
+};
+
+// Заменить файл target файлом source одним действием (старый target пропадает).
+// Когда функция вернула true, и содержимое, и новое имя уже на диске
+bool replaceFile(const std::string& source, const std::string& target);
@@ -0,0 +1,271 @@
+#include "Match_broadcast.h"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring atomics must work across processes");
+static_assert((BROADCAST_CAPACITY & (BROADCAST_CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+// Место кольца: номер события + 1 (0 - пусто или пишется) и событие в двух словах
+struct BroadcastSlot {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> words[2];
+};
+
+// Кольцо в общей памяти. Все поля - атомарные, чтобы процессы не мешали друг другу
+struct BroadcastRing {
+    std::atomic<uint32_t> magic;        // пишется последним, когда кольцо готово
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> capacity;
+    std::atomic<uint32_t> matches;      // сколько партий начато
+    alignas(64) std::atomic<uint64_t> head;     // сколько событий опубликовано
+    alignas(64) BroadcastSlot slots[BROADCAST_CAPACITY];
+};
+
+namespace {
+
+const uint32_t RING_MAGIC = 0x56494C53;     // "SLIV"
+const uint32_t RING_VERSION = 1;
+
+// Кольцо, созданное этой же версией игры
+bool ringReady(const BroadcastRing* ring) {
+    return ring->magic.load(std::memory_order_acquire) == RING_MAGIC
+        && ring->version.load(std::memory_order_relaxed) == RING_VERSION
+        && ring->capacity.load(std::memory_order_relaxed) == BROADCAST_CAPACITY;
+}
+
+uint64_t packDelta0(const MatchDelta& d) {
+    return static_cast<uint64_t>(d.kind) | static_cast<uint64_t>(d.shooter) << 8 | static_cast<uint64_t>(d.cell) << 16
+         | static_cast<uint64_t>(d.outcome) << 24 | static_cast<uint64_t>(d.sunkCell) << 32
+         | static_cast<uint64_t>(d.sunkLength) << 40 | static_cast<uint64_t>(d.sunkHorizontal ? 1 : 0) << 48;
+}
+
+uint64_t packDelta1(const MatchDelta& d) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(d.score)) | static_cast<uint64_t>(d.match) << 32;
+}
+
+MatchDelta unpackDelta(uint64_t word0, uint64_t word1) {
+    MatchDelta d;
+    d.kind = static_cast<uint8_t>(word0);
+    d.shooter = static_cast<uint8_t>(word0 >> 8);
+    d.cell = static_cast<uint8_t>(word0 >> 16);
+    d.outcome = static_cast<uint8_t>(word0 >> 24);
+    d.sunkCell = static_cast<uint8_t>(word0 >> 32);
+    d.sunkLength = static_cast<uint8_t>(word0 >> 40);
+    d.sunkHorizontal = ((word0 >> 48) & 1) != 0;
+    d.score = static_cast<int32_t>(static_cast<uint32_t>(word1));
+    d.match = static_cast<uint32_t>(word1 >> 32);
+    return d;
+}
+
+#ifdef _WIN32
+// Имя отображения в Windows: "/sea_battle_live" -> "Local\sea_battle_live"
+std::string mappingName(const std::string& name) {
+    return "Local\\" + (name.empty() || name[0] != '/' ? name : name.substr(1));
+}
+#endif
+
+}
+
+// Событие выстрела shooter по клетке cell поля target. sunkBefore - target.sunk до выстрела
+MatchDelta shotDelta(int shooter, int cell, const Board& target, const Bitboard& sunkBefore, int score) {
+    MatchDelta delta;
+    delta.kind = BROADCAST_SHOT;
+    delta.shooter = static_cast<uint8_t>(shooter);
+    delta.cell = static_cast<uint8_t>(cell);
+    delta.score = score;
+    Bitboard sunkNow = target.sunk & ~sunkBefore;
+    if (!target.hits.test(cell)) {
+        delta.outcome = SHOT_MISS;
+    }
+    else if (sunkNow.none()) {
+        delta.outcome = SHOT_HIT;
+    }
+    else {
+        // Корабль прямой: вторая клетка горизонтального - в следующем столбце x
+        delta.outcome = CheckShip(target) ? SHOT_SUNK : SHOT_WON;
+        delta.sunkCell = static_cast<uint8_t>(sunkNow.lowest());
+        delta.sunkLength = static_cast<uint8_t>(sunkNow.count());
+        delta.sunkHorizontal = delta.sunkLength > 1 && sunkNow.test(delta.sunkCell + BOARD_SIZE);
+    }
+    return delta;
+}
+
+BroadcastPublisher::~BroadcastPublisher() {
+    close();
+}
+
+// Создать кольцо или подключиться к оставшемуся от прошлого запуска
+bool BroadcastPublisher::open(const std::string& name) {
+    close();
+    void* address = nullptr;
+#ifdef _WIN32
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                       static_cast<DWORD>(sizeof(BroadcastRing)), mappingName(name).c_str());
+    if (handle != nullptr) {
+        address = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(BroadcastRing));
+        if (address == nullptr) CloseHandle(handle);
+        else mapping = handle;
+    }
+#else
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0
+        && (static_cast<size_t>(info.st_size) >= sizeof(BroadcastRing) || ftruncate(fd, sizeof(BroadcastRing)) == 0)) {
+        address = mmap(nullptr, sizeof(BroadcastRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) address = nullptr;
+    }
+    if (fd >= 0) ::close(fd);
+#endif
+    if (address == nullptr) {
+        std::cerr << "Unable to create shared memory: " << name << std::endl;
+        return false;
+    }
+    ring = static_cast<BroadcastRing*>(address);
+    if (!ringReady(ring)) {
+        // Новое кольцо (или от другой версии): читатели ждут, пока не появится метка
+        ring->magic.store(0, std::memory_order_relaxed);
+        std::memset(static_cast<void*>(&ring->slots), 0, sizeof(ring->slots));
+        ring->version.store(RING_VERSION, std::memory_order_relaxed);
+        ring->capacity.store(BROADCAST_CAPACITY, std::memory_order_relaxed);
+        ring->matches.store(0, std::memory_order_relaxed);
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->magic.store(RING_MAGIC, std::memory_order_release);
+    }
+    match = ring->matches.load(std::memory_order_relaxed);
+    return true;
+}
+
+void BroadcastPublisher::close() {
+    if (ring == nullptr) return;
+    // Само кольцо остаётся: читатели дочитают его, а следующий запуск продолжит нумерацию
+#ifdef _WIN32
+    UnmapViewOfFile(ring);
+    CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    munmap(ring, sizeof(BroadcastRing));
+#endif
+    ring = nullptr;
+}
+
+// Несколько записей в память, без системных вызовов и блокировок. Номер партии ставится свой
+void BroadcastPublisher::publish(const MatchDelta& delta) {
+    if (ring == nullptr) return;
+    uint64_t number = ring->head.load(std::memory_order_relaxed);
+    BroadcastSlot& slot = ring->slots[number & (BROADCAST_CAPACITY - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    MatchDelta stamped = delta;
+    stamped.match = match;
+    slot.words[0].store(packDelta0(stamped), std::memory_order_relaxed);
+    slot.words[1].store(packDelta1(stamped), std::memory_order_relaxed);
+    slot.sequence.store(number + 1, std::memory_order_release);
+    ring->head.store(number + 1, std::memory_order_release);
+}
+
+// Событие новой партии; номер партии растёт
+void BroadcastPublisher::startMatch(int score) {
+    if (ring == nullptr) return;
+    ring->matches.store(++match, std::memory_order_relaxed);
+    MatchDelta delta;
+    delta.kind = BROADCAST_NEW_MATCH;
+    delta.outcome = 0;
+    delta.score = score;
+    publish(delta);
+}
+
+BroadcastReader::~BroadcastReader() {
+    close();
+}
+
+// Подключиться к кольцу и читать с самого старого события в нём,
+// чтобы подключившийся посреди партии мог восстановить её начало
+bool BroadcastReader::open(const std::string& name) {
+    close();
+    const void* address = nullptr;
+#ifdef _WIN32
+    // 64-битные атомарные чтения 32-битной сборки MSVC пишут в память, им нужна запись
+    DWORD access = sizeof(void*) < 8 ? FILE_MAP_READ | FILE_MAP_WRITE : FILE_MAP_READ;
+    HANDLE handle = OpenFileMappingA(access, FALSE, mappingName(name).c_str());
+    if (handle != nullptr) {
+        address = MapViewOfFile(handle, access, 0, 0, sizeof(BroadcastRing));
+        if (address == nullptr) CloseHandle(handle);
+        else mapping = handle;
+    }
+#else
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(BroadcastRing)) {
+        address = mmap(nullptr, sizeof(BroadcastRing), PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) address = nullptr;
+    }
+    if (fd >= 0) ::close(fd);
+#endif
+    if (address == nullptr) {
+        std::cerr << "No live game to watch: " << name << std::endl;
+        return false;
+    }
+    ring = static_cast<const BroadcastRing*>(address);
+    if (!ringReady(ring)) {
+        std::cerr << "Not a game broadcast: " << name << std::endl;
+        close();
+        return false;
+    }
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    position = head > BROADCAST_CAPACITY ? head - BROADCAST_CAPACITY : 0;
+    return true;
+}
+
+void BroadcastReader::close() {
+    if (ring == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(ring);
+    CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    munmap(const_cast<BroadcastRing*>(ring), sizeof(BroadcastRing));
+#endif
+    ring = nullptr;
+}
+
+// Следующее событие; false - новых нет
+bool BroadcastReader::next(MatchDelta& delta, uint64_t& lost) {
+    lost = 0;
+    if (ring == nullptr) return false;
+    for (;;) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head - position > BROADCAST_CAPACITY) {
+            lost += head - BROADCAST_CAPACITY - position;
+            position = head - BROADCAST_CAPACITY;
+        }
+        if (position == head) return false;
+        const BroadcastSlot& slot = ring->slots[position & (BROADCAST_CAPACITY - 1)];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        uint64_t word0 = slot.words[0].load(std::memory_order_relaxed);
+        uint64_t word1 = slot.words[1].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+        if (before == position + 1 && after == before) {
+            delta = unpackDelta(word0, word1);
+            position++;
+            return true;
+        }
+        // Писатель обогнал на круг, пока событие читалось: дальше с середины кольца,
+        // чтобы не догонять его вплотную
+        uint64_t resume = ring->head.load(std::memory_order_acquire) - BROADCAST_CAPACITY / 2;
+        if (resume <= position) resume = position + 1;
+        lost += resume - position;
+        position = resume;
+    }
+}
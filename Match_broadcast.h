@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Net_protocol.h"
+#include "Rules.h"
+
+//-----------// Трансляция партии другим процессам через общую память
+
+// Игра пишет события партии в кольцо в общей памяти (POSIX shm, в Windows - именованное
+// отображение), а оверлеи, панели статистики и зрители читают его сами. Писатель один,
+// читателей сколько угодно: они только читают память и игре ничего не стоят.
+// У каждого места кольца свой номер события. Писатель сначала портит номер, потом пишет
+// событие и ставит новый номер; читатель сверяет номер до и после чтения, поэтому
+// отставший читатель видит, что событие перезаписано, и узнаёт, сколько пропустил.
+
+const char* const BROADCAST_NAME = "/sea_battle_live";
+const uint32_t BROADCAST_CAPACITY = 256;    // событий в кольце (степень двойки)
+
+enum BroadcastKind : uint8_t {
+    BROADCAST_NEW_MATCH = 1,    // началась (или продолжилась после запуска) партия
+    BROADCAST_SHOT = 2          // выстрел
+};
+
+// Событие партии
+struct MatchDelta {
+    uint8_t kind = BROADCAST_SHOT;
+    uint8_t shooter = 0;        // 0 - игрок, 1 - компьютер
+    uint8_t cell = 0;           // номер клетки x * 10 + y
+    uint8_t outcome = SHOT_MISS;
+    uint8_t sunkCell = 0;       // младшая клетка потопленного корабля (SHOT_SUNK, SHOT_WON)
+    uint8_t sunkLength = 0;     // его длина (0 - ничего не потоплено)
+    bool sunkHorizontal = false;
+    int32_t score = 0;          // счёт игрока после выстрела
+    uint32_t match = 0;         // номер партии (ставит писатель)
+};
+
+// Событие выстрела shooter по клетке cell поля target. sunkBefore - target.sunk до выстрела
+MatchDelta shotDelta(int shooter, int cell, const Board& target, const Bitboard& sunkBefore, int score);
+
+struct BroadcastRing;
+
+// Писатель (игра)
+class BroadcastPublisher {
+public:
+    BroadcastPublisher() = default;
+    ~BroadcastPublisher();
+    BroadcastPublisher(const BroadcastPublisher&) = delete;
+    BroadcastPublisher& operator=(const BroadcastPublisher&) = delete;
+
+    // Создать кольцо или подключиться к оставшемуся от прошлого запуска (нумерация продолжается)
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const { return ring != nullptr; }
+
+    // Несколько записей в память, без системных вызовов и блокировок. Номер партии ставится свой
+    void publish(const MatchDelta& delta);
+    // Событие новой партии; номер партии растёт
+    void startMatch(int score);
+
+private:
+    BroadcastRing* ring = nullptr;
+    uint32_t match = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;    // HANDLE
+#endif
+};
+
+// Читатель (любой процесс)
+class BroadcastReader {
+public:
+    BroadcastReader() = default;
+    ~BroadcastReader();
+    BroadcastReader(const BroadcastReader&) = delete;
+    BroadcastReader& operator=(const BroadcastReader&) = delete;
+
+    // Подключиться к кольцу; чтение начинается с самого старого события в нём
+    bool open(const std::string& name);
+    void close();
+
+    // Следующее событие; false - новых нет. lost - сколько событий перезаписано,
+    // пока читатель отставал (они пропускаются)
+    bool next(MatchDelta& delta, uint64_t& lost);
+
+private:
+    const BroadcastRing* ring = nullptr;
+    uint64_t position = 0;      // номер следующего события
+#ifdef _WIN32
+    void* mapping = nullptr;    // HANDLE
+#endif
+};
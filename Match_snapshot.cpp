@@ -0,0 +1,177 @@
+#include "Match_snapshot.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const uint8_t SNAPSHOT_MAGIC[4] = { 'S', 'B', 'S', 'V' };
+const size_t HEADER_BYTES = 4 + 2 + 2 + 4;     // метка, версия, длина данных, контрольная сумма
+const int SNAPSHOT_LAYERS = 4;                 // ships, hits, misses, sunk
+
+void putBytes(uint8_t*& out, uint64_t value, int count) {
+    for (int i = 0; i < count; ++i) *out++ = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint64_t getBytes(const uint8_t*& in, int count) {
+    uint64_t value = 0;
+    for (int i = 0; i < count; ++i) value |= static_cast<uint64_t>(*in++) << (8 * i);
+    return value;
+}
+
+// FNV-1a: ловит обрывы и порчу снимка
+uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+}
+
+// Снимок в out; число записанных байт (0, если не хватило capacity)
+size_t writeSnapshot(const MatchSnapshot& s, uint8_t* out, size_t capacity) {
+    size_t size = HEADER_BYTES + 6 + 4 + 8 + 8 + FLEET_SIZE + 2 * SNAPSHOT_LAYERS * BITBOARD_BYTES + 1
+                + static_cast<size_t>(s.shotCount);
+    if (s.shotCount < 0 || s.shotCount > 2 * CELL_COUNT || size > capacity) return 0;
+    uint8_t* p = out + HEADER_BYTES;
+    *p++ = static_cast<uint8_t>(s.phase);
+    *p++ = static_cast<uint8_t>(s.difficulty);
+    *p++ = static_cast<uint8_t>(s.currentShip);
+    *p++ = static_cast<uint8_t>(s.cursorX);
+    *p++ = static_cast<uint8_t>(s.cursorY);
+    *p++ = static_cast<uint8_t>(s.shotsLeft);
+    putBytes(p, static_cast<uint32_t>(s.score), 4);
+    putBytes(p, s.rng, 8);
+    putBytes(p, s.replaySeed, 8);
+    // Корабль - клетка начала и старший бит за горизонталь
+    for (const SavedShip& ship : s.ships) {
+        *p++ = static_cast<uint8_t>(cellIndex(ship.x, ship.y) | (ship.horizontal ? 0x80 : 0));
+    }
+    for (const Board& board : s.boards) {
+        const Bitboard* layers[SNAPSHOT_LAYERS] = { &board.ships, &board.hits, &board.misses, &board.sunk };
+        for (const Bitboard* layer : layers) {
+            packBitboard(*layer, p);
+            p += BITBOARD_BYTES;
+        }
+    }
+    *p++ = static_cast<uint8_t>(s.shotCount);
+    std::memcpy(p, s.shots, static_cast<size_t>(s.shotCount));
+
+    uint8_t* head = out;
+    std::memcpy(head, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    head += sizeof(SNAPSHOT_MAGIC);
+    putBytes(head, SNAPSHOT_VERSION, 2);
+    putBytes(head, size - HEADER_BYTES, 2);
+    putBytes(head, checksum(out + HEADER_BYTES, size - HEADER_BYTES), 4);
+    return size;
+}
+
+// Снимок из size байт; false, если данные испорчены или версия неизвестна
+bool readSnapshot(const uint8_t* in, size_t size, MatchSnapshot& s) {
+    if (size < HEADER_BYTES || std::memcmp(in, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) return false;
+    const uint8_t* p = in + sizeof(SNAPSHOT_MAGIC);
+    uint64_t version = getBytes(p, 2);
+    size_t payload = static_cast<size_t>(getBytes(p, 2));
+    uint32_t sum = static_cast<uint32_t>(getBytes(p, 4));
+    if (version < 1 || version > static_cast<uint64_t>(SNAPSHOT_VERSION) || payload > size - HEADER_BYTES || checksum(p, payload) != sum) return false;
+    const uint8_t* end = p + payload;
+
+    size_t fixed = 6 + 4 + 8 + 8 + FLEET_SIZE + 2 * SNAPSHOT_LAYERS * BITBOARD_BYTES + 1;
+    if (payload < fixed) return false;
+    MatchSnapshot loaded;
+    if (p[0] > static_cast<uint8_t>(MatchPhase::EnemyAttack) || p[1] > 2 || p[2] > FLEET_SIZE
+        || p[3] >= BOARD_SIZE || p[4] >= BOARD_SIZE) return false;
+    loaded.phase = static_cast<MatchPhase>(p[0]);
+    loaded.difficulty = p[1];
+    loaded.currentShip = p[2];
+    loaded.cursorX = p[3];
+    loaded.cursorY = p[4];
+    loaded.shotsLeft = p[5];
+    p += 6;
+    loaded.score = static_cast<int32_t>(static_cast<uint32_t>(getBytes(p, 4)));
+    loaded.rng = getBytes(p, 8);
+    loaded.replaySeed = getBytes(p, 8);
+    for (SavedShip& ship : loaded.ships) {
+        int cell = *p & 0x7F;
+        if (cell >= CELL_COUNT) return false;
+        ship.x = cell / BOARD_SIZE;
+        ship.y = cell % BOARD_SIZE;
+        ship.horizontal = (*p++ & 0x80) != 0;
+    }
+    for (Board& board : loaded.boards) {
+        Bitboard* layers[SNAPSHOT_LAYERS] = { &board.ships, &board.hits, &board.misses, &board.sunk };
+        for (Bitboard* layer : layers) {
+            *layer = unpackBitboard(p);
+            p += BITBOARD_BYTES;
+        }
+    }
+    loaded.shotCount = *p++;
+    if (loaded.shotCount > end - p) return false;
+    for (int i = 0; i < loaded.shotCount; ++i) {
+        if (p[i] >= CELL_COUNT) return false;
+        loaded.shots[i] = p[i];
+    }
+    s = loaded;
+    return true;
+}
+
+bool SnapshotFile::open(const std::string& path) {
+    if (!file.openWrite(path, 2 * SLOT_BYTES) || file.size() < 2 * SLOT_BYTES) {
+        file.close();
+        return false;
+    }
+    // Дальше снимки нумеруются от самого нового из сохранённых
+    sequence = 0;
+    lastSlot = 1;
+    for (int slot = 0; slot < 2; ++slot) {
+        const uint8_t* p = file.data() + slot * SLOT_BYTES;
+        uint32_t number = static_cast<uint32_t>(getBytes(p, 4));
+        if (number > sequence) {
+            sequence = number;
+            lastSlot = slot;
+        }
+    }
+    return true;
+}
+
+// Место: номер снимка (4 байта), его длина (4 байта), снимок. Номер пишется
+// последним, так что недописанный снимок не считается новым
+bool SnapshotFile::save(const MatchSnapshot& snapshot) {
+    if (!file.isOpen()) return false;
+    int slot = 1 - lastSlot;
+    uint8_t* base = file.data() + slot * SLOT_BYTES;
+    size_t size = writeSnapshot(snapshot, base + 8, SNAPSHOT_MAX_BYTES);
+    if (size == 0) return false;
+    uint8_t* p = base + 4;
+    putBytes(p, size, 4);
+    p = base;
+    putBytes(p, ++sequence, 4);
+    lastSlot = slot;
+    return true;
+}
+
+// Последний целый снимок; false, если сохранённой партии нет
+bool SnapshotFile::load(MatchSnapshot& snapshot) {
+    if (!file.isOpen()) return false;
+    // Сначала новое место, потом старое
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        int slot = attempt == 0 ? lastSlot : 1 - lastSlot;
+        const uint8_t* p = file.data() + slot * SLOT_BYTES;
+        uint32_t number = static_cast<uint32_t>(getBytes(p, 4));
+        size_t size = static_cast<size_t>(getBytes(p, 4));
+        if (number == 0) continue;
+        if (size <= SNAPSHOT_MAX_BYTES && readSnapshot(p, size, snapshot)) return true;
+        std::cerr << "Damaged autosave, snapshot " << number << " skipped" << std::endl;
+    }
+    return false;
+}
+
+// Партия закончилась: продолжать нечего
+void SnapshotFile::clear() {
+    if (!file.isOpen()) return;
+    for (int slot = 0; slot < 2; ++slot) {
+        uint8_t* p = file.data() + slot * SLOT_BYTES;
+        putBytes(p, 0, 4);
+    }
+    sequence = 0;
+    lastSlot = 1;
+}
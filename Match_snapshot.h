@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Mapped_file.h"
+#include "Rules.h"
+
+//-----------// Снимки идущей партии: сохранение и продолжение
+
+// Снимок - всё, что нужно, чтобы продолжить партию игрока с компьютером с того же места:
+// оба поля, расстановка, курсор, счёт, генератор и выстрелы для записи партии.
+// В двоичном виде это заголовок (метка, версия, длина, контрольная сумма) и поля
+// по 13 байт на слой - обычно 150-350 байт. Числа записываются в порядке little-endian.
+// Стратегия компьютера в снимок не входит: она смотрит только на поле и начинает заново.
+
+const int SNAPSHOT_VERSION = 1;
+// Больше снимок не бывает: выстрелов не больше, чем клеток на двух полях
+const size_t SNAPSHOT_MAX_BYTES = 512;
+
+// Где остановилась партия
+enum class MatchPhase : uint8_t {
+    Placement,      // игрок расставляет флот
+    PlayerAttack,   // ход игрока
+    EnemyAttack     // ход компьютера
+};
+
+// Положение корабля игрока (длина известна по номеру во FLEET)
+struct SavedShip {
+    int x = 0, y = 0;
+    bool horizontal = true;
+};
+
+struct MatchSnapshot {
+    MatchPhase phase = MatchPhase::Placement;
+    int difficulty = 1;             // номер сложности в главном меню
+    Board boards[2];                // [0] - поле игрока, [1] - поле компьютера
+    SavedShip ships[FLEET_SIZE];
+    int currentShip = 0;            // сколько кораблей уже поставлено
+    int cursorX = 0, cursorY = 0;
+    int score = 100;
+    int shotsLeft = 100;            // number_of_shots
+    uint64_t rng = 0;               // состояние генератора
+    uint64_t replaySeed = 0;        // Replay::seed партии
+    int shotCount = 0;              // выстрелы обеих сторон по порядку (Replay::shots)
+    uint8_t shots[2 * CELL_COUNT] = {};
+};
+
+// Снимок в out; число записанных байт (0, если не хватило capacity)
+size_t writeSnapshot(const MatchSnapshot& snapshot, uint8_t* out, size_t capacity);
+// Снимок из size байт; false, если данные испорчены или версия неизвестна
+bool readSnapshot(const uint8_t* in, size_t size, MatchSnapshot& snapshot);
+
+// Автосохранение в файле, отображённом в память. Сохранение - копирование в память
+// без обращений к системе, поэтому его можно делать после каждого выстрела. В файле
+// два места: новый снимок пишется поверх старшего, и если программа упадёт посреди
+// записи, останется предыдущий
+class SnapshotFile {
+public:
+    bool open(const std::string& path);
+    bool save(const MatchSnapshot& snapshot);
+    // Последний целый снимок; false, если сохранённой партии нет
+    bool load(MatchSnapshot& snapshot);
+    // Партия закончилась: продолжать нечего
+    void clear();
+
+private:
+    static const size_t SLOT_BYTES = 8 + SNAPSHOT_MAX_BYTES;
+
+    MappedFile file;
+    uint32_t sequence = 0;      // номер последнего снимка (0 - снимков нет)
+    int lastSlot = 1;
+};
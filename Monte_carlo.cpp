@@ -0,0 +1,115 @@
+#include "Monte_carlo.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "Fleet_sampler.h"
+
+namespace {
+
+// Расстановок в одной задаче пула
+const int BATCH = 32;
+const int MAX_TASKS = 1 << 16;
+
+typedef std::chrono::steady_clock Clock;
+
+// Выборка в одной задаче: до BATCH расстановок или до крайнего срока
+void sampleBatch(const FleetConstraints& constraints, const Bitboard& freeCells, Rng& rng,
+                 Clock::time_point deadline, int* counts, long long& samples) {
+    for (int i = 0; i < BATCH; ++i) {
+        if (Clock::now() >= deadline) return;
+        Bitboard ships;
+        if (!sampleFleet(constraints, rng, ships)) continue;
+        Bitboard candidates = ships & freeCells;
+        while (candidates.any()) {
+            int cell = candidates.lowest();
+            candidates.reset(cell);
+            counts[cell]++;
+        }
+        samples++;
+    }
+}
+
+}
+
+MonteCarloOpponent::MonteCarloOpponent(ThreadPool* pool, double budgetMs)
+    : pool(pool), budgetMs(budgetMs), tallies(pool ? pool->size() : 1) {
+}
+
+void MonteCarloOpponent::reset() {
+    fallback.reset();
+}
+
+int MonteCarloOpponent::chooseShot(const Board& board, Rng& rng) {
+    FleetConstraints constraints = constraintsFromBoard(board);
+    Bitboard freeCells = ~board.shot();
+    for (Tally& tally : tallies) {
+        std::fill(tally.counts, tally.counts + CELL_COUNT, 0);
+        tally.samples = 0;
+    }
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(budgetMs));
+    uint64_t baseSeed = rng.next();
+
+    if (pool) {
+        // Задач с запасом по скорости прошлого хода: лишние сразу видят истёкший срок
+        double expected = rateEstimate * budgetMs / 1000.0 / BATCH * 1.5;
+        int tasks = static_cast<int>(std::min<double>(MAX_TASKS, std::max<double>(pool->size() * 64, expected)));
+        pool->run(tasks, [&](int index, int worker) {
+            Rng local(baseSeed + static_cast<uint64_t>(index) * 0x9E3779B97F4A7C15ull);
+            sampleBatch(constraints, freeCells, local, deadline, tallies[worker].counts, tallies[worker].samples);
+        });
+    }
+    else {
+        Rng local(baseSeed);
+        while (Clock::now() < deadline) {
+            sampleBatch(constraints, freeCells, local, deadline, tallies[0].counts, tallies[0].samples);
+        }
+    }
+
+    lastSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    lastSamples = 0;
+    int counts[CELL_COUNT] = {};
+    for (const Tally& tally : tallies) {
+        lastSamples += tally.samples;
+        for (int cell = 0; cell < CELL_COUNT; ++cell) counts[cell] += tally.counts[cell];
+    }
+    totalSamples += lastSamples;
+    totalSeconds += lastSeconds;
+    if (lastSeconds > 0) rateEstimate = lastSamples / lastSeconds;
+
+    if (lastSamples == 0) {
+        return fallback.chooseShot(board, rng);
+    }
+
+    int best = -1;
+    int ties = 0;
+    while (freeCells.any()) {
+        int cell = freeCells.lowest();
+        freeCells.reset(cell);
+        if (best < 0 || counts[cell] > counts[best]) {
+            best = cell;
+            ties = 1;
+        }
+        else if (counts[cell] == counts[best] && rng.below(++ties) == 0) {
+            best = cell;
+        }
+    }
+    return best;
+}
+
+double MonteCarloOpponent::lastSamplesPerSecond() const {
+    return lastSeconds > 0 ? lastSamples / lastSeconds : 0;
+}
+
+double MonteCarloOpponent::samplesPerSecond() const {
+    return totalSeconds > 0 ? totalSamples / totalSeconds : 0;
+}
+
+std::string MonteCarloOpponent::report() const {
+    std::ostringstream out;
+    out << "montecarlo: " << static_cast<long long>(samplesPerSecond()) << " samples/sec, "
+        << totalSamples << " samples in " << totalSeconds << " s ("
+        << (pool ? pool->size() : 1) << " threads, " << budgetMs << " ms per move)";
+    return out.str();
+}
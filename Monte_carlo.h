@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include "Opponent.h"
+#include "Hunter.h"
+#include "Thread_pool.h"
+
+//-----------// Сложный противник: выборка расстановок флота методом Монте-Карло
+
+// За отведённое на ход время строит как можно больше расстановок, согласованных с
+// видимой частью поля, и стреляет в клетку, занятую кораблём чаще всего.
+class MonteCarloOpponent : public Opponent {
+public:
+    // pool == nullptr - выборка только в вызывающем потоке
+    MonteCarloOpponent(ThreadPool* pool, double budgetMs);
+    const char* name() const override { return "montecarlo"; }
+    void reset() override;
+    int chooseShot(const Board& board, Rng& rng) override;
+    std::string report() const override;
+
+    // Расстановок в секунду за последний ход и в среднем за все ходы
+    double lastSamplesPerSecond() const;
+    double samplesPerSecond() const;
+
+private:
+    // Доля работы одного потока пула
+    struct Tally {
+        int counts[CELL_COUNT];
+        long long samples;
+    };
+
+    ThreadPool* pool;
+    double budgetMs;
+    HuntTargetOpponent fallback;    // если не удалось построить ни одной расстановки
+    std::vector<Tally> tallies;
+    double rateEstimate = 0;        // расстановок в секунду на прошлом ходу
+    long long lastSamples = 0;
+    double lastSeconds = 0;
+    long long totalSamples = 0;
+    double totalSeconds = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+//-----------// Протокол сервера партий
+
+// Все сообщения по 16 байт, первый байт - тип. Клетка - номер x * 10 + y, как в Board,
+// флот - 13 байт (packBitboard). Сторона 0 ходит первой, ход переходит после промаха.
+const int MESSAGE_SIZE = 16;
+const int DEFAULT_PORT = 7777;
+
+enum MessageType : uint8_t {
+    MSG_JOIN = 1,       // [1] - соперник (JoinMode), [2..14] - свой флот или нули (расставит сервер)
+    MSG_SHOT = 2,       // [1] - клетка
+    MSG_START = 0x81,   // [1] - своя сторона, [2..14] - свой флот
+    MSG_RESULT = 0x82,  // [1] - кто стрелял (0 - вы), [2] - клетка, [3] - ShotOutcome, [4] - 1, если следующий ход ваш
+    MSG_ERROR = 0x83,   // [1] - ErrorCode
+    MSG_ABORT = 0x84    // соперник отключился, партия снята
+};
+
+enum JoinMode : uint8_t {
+    JOIN_RANDOM_AI = 0,
+    JOIN_HUNT_AI = 1,
+    JOIN_HUMAN = 2
+};
+
+enum ShotOutcome : uint8_t {
+    SHOT_MISS = 0,
+    SHOT_HIT = 1,
+    SHOT_SUNK = 2,
+    SHOT_WON = 3
+};
+
+enum ErrorCode : uint8_t {
+    ERROR_NOT_YOUR_TURN = 1,    // или нет партии
+    ERROR_BAD_CELL = 2,         // вне поля или уже обстреляна
+    ERROR_BAD_FLEET = 3,
+    ERROR_BAD_MESSAGE = 4
+};
@@ -0,0 +1,275 @@
+#include "Opening_book.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include "Fleet_sampler.h"
+#include "Thread_pool.h"
+#include "Zobrist.h"
+
+const char* const BOOK_FILE = "opening.book";
+
+namespace {
+
+const char BOOK_MAGIC[8] = { 'S', 'B', 'B', 'O', 'O', 'K', '0', '1' };
+const uint32_t BOOK_VERSION = 1;
+
+// Поле, по ключу которого проверяется, что ключи Зобриста не поменялись с момента сборки
+Board referenceBoard() {
+    Board board;
+    board.hits.set(cellIndex(1, 2));
+    board.misses.set(cellIndex(7, 5));
+    board.sunk.set(cellIndex(4, 9));
+    return board;
+}
+
+// Пустая ячейка помечается нулевым ключом, поэтому ключ позиции нулём не бывает
+uint64_t bookKey(const Board& view) {
+    uint64_t key = zobristKey(view);
+    return key != 0 ? key : 1;
+}
+
+}
+
+struct BookHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t depth;             // на сколько первых выстрелов построена книга
+    uint64_t bucketCount;       // степень двойки
+    uint64_t entryCount;
+    uint64_t keyCheck;          // ключ referenceBoard() при сборке
+    uint64_t reserved;
+};
+
+static_assert(sizeof(BookEntry) == 16, "BookEntry layout");
+static_assert(sizeof(BookHeader) == 48, "BookHeader layout");
+
+bool OpeningBook::open(const std::string& path) {
+    header = nullptr;
+    entries = nullptr;
+    if (!file.openRead(path)) return false;
+    const unsigned char* data = static_cast<const MappedFile&>(file).data();
+    const BookHeader* h = reinterpret_cast<const BookHeader*>(data);
+    if (file.size() < sizeof(BookHeader) || std::memcmp(h->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 ||
+        h->version != BOOK_VERSION || h->bucketCount == 0 || (h->bucketCount & (h->bucketCount - 1)) != 0 ||
+        h->bucketCount > (file.size() - sizeof(BookHeader)) / sizeof(BookEntry) || h->entryCount >= h->bucketCount) {
+        std::cerr << "Not an opening book or damaged: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    if (h->keyCheck != bookKey(referenceBoard())) {
+        std::cerr << "Opening book was built with other position keys: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    header = h;
+    entries = reinterpret_cast<const BookEntry*>(data + sizeof(BookHeader));
+    mask = h->bucketCount - 1;
+    return true;
+}
+
+// Выстрел для позиции view; false, если позиции нет в книге
+bool OpeningBook::lookup(const Board& view, Rng& rng, int& cell) const {
+    if (entries == nullptr) return false;
+    uint64_t key = bookKey(view);
+    // Не дольше одного круга: в испорченной книге пустой ячейки может не быть
+    uint64_t slot = key & mask;
+    for (uint64_t probe = 0; probe <= mask; ++probe, slot = (slot + 1) & mask) {
+        const BookEntry& entry = entries[slot];
+        if (entry.key == 0) return false;
+        if (entry.key == key) {
+            if (entry.count == 0 || entry.count > BOOK_CHOICES) return false;
+            cell = entry.cells[entry.count > 1 ? rng.below(entry.count) : 0];
+            // Книга могла устареть: в уже обстрелянную клетку не стреляем
+            return cell < CELL_COUNT && !view.shot().test(cell);
+        }
+    }
+    return false;
+}
+
+uint32_t OpeningBook::size() const {
+    return header ? static_cast<uint32_t>(header->entryCount) : 0;
+}
+
+int OpeningBook::depth() const {
+    return header ? static_cast<int>(header->depth) : 0;
+}
+
+// Книга по умолчанию (BOOK_FILE рядом с игрой, открывается при первом обращении; может быть пустой)
+const OpeningBook& defaultOpeningBook() {
+    static OpeningBook book;
+    static bool opened = std::ifstream(BOOK_FILE).good() && book.open(BOOK_FILE);
+    (void)opened;
+    return book;
+}
+
+//-----------// Сборка книги
+
+namespace {
+
+// Лучшие выстрелы в позиции: клетки, чаще всего занятые кораблями в случайных расстановках
+BookEntry bestShots(const Board& view, int shots, const BookBuildOptions& options, Rng& rng) {
+    FleetConstraints constraints = constraintsFromBoard(view);
+    Bitboard freeCells = ~view.shot();
+    int counts[CELL_COUNT] = {};
+    for (int i = 0; i < options.samples; ++i) {
+        Bitboard ships;
+        if (!sampleFleet(constraints, rng, ships)) continue;
+        Bitboard covered = ships & freeCells;
+        while (covered.any()) {
+            int cell = covered.lowest();
+            covered.reset(cell);
+            counts[cell]++;
+        }
+    }
+
+    std::vector<int> order;
+    Bitboard cells = freeCells;
+    while (cells.any()) {
+        int cell = cells.lowest();
+        cells.reset(cell);
+        order.push_back(cell);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return counts[a] > counts[b]; });
+
+    BookEntry entry = {};
+    entry.key = bookKey(view);
+    entry.shots = static_cast<uint8_t>(shots);
+    int best = order.empty() ? 0 : counts[order[0]];
+    for (int cell : order) {
+        if (entry.count == BOOK_CHOICES || counts[cell] < best * (1 - options.tolerance)) break;
+        entry.cells[entry.count++] = static_cast<uint8_t>(cell);
+    }
+    return entry;
+}
+
+// Видимая часть поля
+Board viewOf(const Board& board) {
+    Board view = board;
+    view.ships = Bitboard();
+    return view;
+}
+
+}
+
+// Собрать книгу самоигрой и записать в path; false при ошибке записи
+bool buildOpeningBook(const BookBuildOptions& options, const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    Rng rng(options.seed);
+    std::vector<Board> targets(static_cast<size_t>(options.games));
+    for (Board& target : targets) fillGridWithShips(target, rng);
+
+    // Позиции собираются волнами: все партии делают выстрел номер shot,
+    // новые позиции этой волны считаются параллельно
+    std::unordered_map<uint64_t, BookEntry> book;
+    std::vector<bool> inBook(targets.size(), true);
+    for (int shot = 0; shot < options.depth; ++shot) {
+        // Новые позиции и сколько партий в них пришло; редкие в книгу не попадают
+        std::unordered_map<uint64_t, std::pair<int, size_t>> fresh;
+        for (size_t g = 0; g < targets.size(); ++g) {
+            if (!inBook[g]) continue;
+            uint64_t key = bookKey(targets[g]);
+            if (book.count(key)) continue;
+            auto inserted = fresh.emplace(key, std::make_pair(0, g));
+            inserted.first->second.first++;
+        }
+        std::vector<Board> positions;
+        for (const auto& item : fresh) {
+            if (item.second.first >= options.minVisits) positions.push_back(viewOf(targets[item.second.second]));
+        }
+
+        std::vector<BookEntry> results(positions.size());
+        uint64_t waveSeed = rng.next();
+        defaultThreadPool().run(static_cast<int>(positions.size()), [&](int index, int) {
+            Rng local(waveSeed + static_cast<uint64_t>(index) * 0x9E3779B97F4A7C15ull);
+            results[index] = bestShots(positions[index], shot, options, local);
+        });
+        for (const BookEntry& entry : results) book.emplace(entry.key, entry);
+
+        // Каждая партия делает выстрел из книги
+        for (size_t g = 0; g < targets.size(); ++g) {
+            if (!inBook[g]) continue;
+            auto found = book.find(bookKey(targets[g]));
+            if (found == book.end() || found->second.count == 0 || !CheckShip(targets[g])) {
+                inBook[g] = false;
+                continue;
+            }
+            const BookEntry& entry = found->second;
+            shootCell(targets[g], entry.cells[rng.below(entry.count)]);
+            surroundSunkShips(targets[g]);
+        }
+        std::cout << "shot " << shot + 1 << ": " << positions.size() << " new positions, "
+                  << book.size() << " total" << std::endl;
+    }
+
+    // Хеш-таблица заполнена не больше чем наполовину
+    uint64_t buckets = 1;
+    while (buckets < 2 * book.size()) buckets <<= 1;
+    std::vector<BookEntry> table(static_cast<size_t>(buckets));
+    uint64_t written = 0;
+    for (const auto& item : book) {
+        if (item.second.count == 0) continue;
+        written++;
+        uint64_t slot = item.first & (buckets - 1);
+        while (table[slot].key != 0) slot = (slot + 1) & (buckets - 1);
+        table[slot] = item.second;
+    }
+
+    BookHeader header = {};
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = BOOK_VERSION;
+    header.depth = static_cast<uint32_t>(options.depth);
+    header.bucketCount = buckets;
+    header.entryCount = written;
+    header.keyCheck = bookKey(referenceBoard());
+
+    std::string tempPath = path + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(BookEntry)));
+    file.close();
+    if (file.fail() || !replaceFile(tempPath, path)) {
+        std::cerr << "Failed to write " << path << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Opening book: " << written << " positions, " << sizeof(header) + table.size() * sizeof(BookEntry)
+              << " bytes, " << seconds << " s" << std::endl;
+    return true;
+}
+
+//-----------// Противник
+
+BookOpponent::BookOpponent(std::unique_ptr<Opponent> base, const OpeningBook& book)
+    : base(std::move(base)), book(book) {
+    label = std::string(this->base->name()) + "+book";
+}
+
+void BookOpponent::reset() {
+    base->reset();
+}
+
+int BookOpponent::chooseShot(const Board& board, Rng& rng) {
+    int cell;
+    if (book.lookup(board, rng, cell)) {
+        bookMoves++;
+        return cell;
+    }
+    otherMoves++;
+    return base->chooseShot(board, rng);
+}
+
+std::string BookOpponent::report() const {
+    std::ostringstream out;
+    std::string baseReport = base->report();
+    if (!baseReport.empty()) out << baseReport << "\n";
+    out << "book: " << bookMoves << " moves from the book (" << book.size() << " positions, depth "
+        << book.depth() << "), " << otherMoves << " computed";
+    return out.str();
+}
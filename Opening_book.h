@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Mapped_file.h"
+#include "Opponent.h"
+
+//-----------// Дебютная книга: лучшие первые выстрелы, посчитанные заранее
+
+// Файл - заголовок и хеш-таблица с открытой адресацией: ключ позиции по Зобристу
+// и до BOOK_CHOICES равноценных выстрелов. Файл отображается в память как есть,
+// поэтому открытие ничего не разбирает, а поиск хода - одна-две пробы таблицы.
+
+const int BOOK_CHOICES = 4;
+
+// Запись книги (16 байт)
+struct BookEntry {
+    uint64_t key;                   // 0 - пустая ячейка
+    uint8_t cells[BOOK_CHOICES];    // равноценные выстрелы, лучший первым
+    uint8_t count;                  // сколько из них заполнено
+    uint8_t shots;                  // сколько выстрелов уже сделано в этой позиции
+    uint16_t reserved;
+};
+
+struct BookHeader;
+
+// Книга, открытая только для чтения
+class OpeningBook {
+public:
+    bool open(const std::string& path);
+    bool isOpen() const { return entries != nullptr; }
+    // Выстрел для позиции view; false, если позиции нет в книге
+    bool lookup(const Board& view, Rng& rng, int& cell) const;
+
+    uint32_t size() const;
+    int depth() const;
+
+private:
+    MappedFile file;
+    const BookHeader* header = nullptr;
+    const BookEntry* entries = nullptr;
+    uint64_t mask = 0;
+};
+
+// Книга по умолчанию (BOOK_FILE рядом с игрой, открывается при первом обращении; может быть пустой)
+const OpeningBook& defaultOpeningBook();
+extern const char* const BOOK_FILE;
+
+// Параметры построения книги
+struct BookBuildOptions {
+    long long games = 100000;   // партий, по которым собираются встречающиеся позиции
+    int depth = 12;             // на сколько первых выстрелов строится книга
+    int minVisits = 4;          // позиция попадает в книгу, если в неё пришло столько партий
+    int samples = 20000;        // расстановок флота на позицию
+    double tolerance = 0.01;    // выстрелы не хуже лучшего на эту долю считаются равноценными
+    uint64_t seed = 1;
+};
+
+// Собрать книгу самоигрой и записать в path; false при ошибке записи
+bool buildOpeningBook(const BookBuildOptions& options, const std::string& path);
+
+// Стратегия, которая первые выстрелы берёт из книги, а дальше играет как base
+class BookOpponent : public Opponent {
+public:
+    BookOpponent(std::unique_ptr<Opponent> base, const OpeningBook& book);
+    const char* name() const override { return label.c_str(); }
+    void reset() override;
+    int chooseShot(const Board& board, Rng& rng) override;
+    std::string report() const override;
+
+private:
+    std::unique_ptr<Opponent> base;
+    const OpeningBook& book;
+    std::string label;
+    long long bookMoves = 0;
+    long long otherMoves = 0;
+};
@@ -0,0 +1,56 @@
+#include "Opponent.h"
+#include <cstdlib>
+#include "Hunter.h"
+#include "Monte_carlo.h"
+#include "Endgame_solver.h"
+#include "Opening_book.h"
+
+int RandomOpponent::chooseShot(const Board& board, Rng& rng) {
+    return randomFreeCell(board, rng);
+}
+
+// Стратегия по имени: "random", "hunt", "montecarlo" или "montecarlo:MS"
+std::unique_ptr<Opponent> makeOpponent(const std::string& name) {
+    return makeOpponent(name, &defaultThreadPool());
+}
+
+// То же, но сложные стратегии считают на пуле pool (nullptr - только в вызывающем потоке)
+std::unique_ptr<Opponent> makeOpponent(const std::string& name, ThreadPool* pool) {
+    // "NAME+endgame" или "NAME+endgame:N": в конце партии, когда расстановок не больше N, - точный перебор
+    size_t plus = name.find("+endgame");
+    if (plus != std::string::npos) {
+        EndgameSettings settings;
+        std::string suffix = name.substr(plus + 8);
+        if (suffix.size() > 1 && suffix[0] == ':') settings.maxLayouts = std::atoi(suffix.c_str() + 1);
+        else if (!suffix.empty()) return nullptr;
+        if (settings.maxLayouts <= 0 || settings.maxLayouts > 4096) return nullptr;
+        std::unique_ptr<Opponent> base = makeOpponent(name.substr(0, plus), pool);
+        if (!base) return nullptr;
+        return std::unique_ptr<Opponent>(new EndgameOpponent(std::move(base), settings));
+    }
+    // "NAME+book": первые выстрелы из дебютной книги
+    if (name.size() > 5 && name.compare(name.size() - 5, 5, "+book") == 0) {
+        std::unique_ptr<Opponent> base = makeOpponent(name.substr(0, name.size() - 5), pool);
+        if (!base) return nullptr;
+        return std::unique_ptr<Opponent>(new BookOpponent(std::move(base), defaultOpeningBook()));
+    }
+    if (name == "random") return std::unique_ptr<Opponent>(new RandomOpponent());
+    if (name == "hunt") return std::unique_ptr<Opponent>(new HuntTargetOpponent());
+    if (name.compare(0, 10, "montecarlo") == 0) {
+        double budgetMs = 5;
+        if (name.size() > 11 && name[10] == ':') budgetMs = std::strtod(name.c_str() + 11, nullptr);
+        else if (name.size() != 10) return nullptr;
+        if (budgetMs <= 0) return nullptr;
+        return std::unique_ptr<Opponent>(new MonteCarloOpponent(pool, budgetMs));
+    }
+    return nullptr;
+}
+
+const char* opponentNames() {
+    return "random, hunt, montecarlo[:MS], any of them with +book and/or +endgame[:LAYOUTS]";
+}
+
+// Ход компьютера: выстрел в клетку, выбранную стратегией (как EnemyAttack)
+bool opponentAttack(Board& grid, Opponent& opponent, Rng& rng) {
+    return shootCell(grid, opponent.chooseShot(grid, rng));
+}
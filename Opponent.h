@@ -0,0 +1,39 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "Rules.h"
+
+//-----------// Стратегии стрельбы компьютера
+
+class Opponent {
+public:
+    virtual ~Opponent() = default;
+    virtual const char* name() const = 0;
+    // Начало новой партии
+    virtual void reset() {}
+    // Номер клетки для следующего выстрела. Смотрит только на hits, misses и sunk
+    virtual int chooseShot(const Board& board, Rng& rng) = 0;
+    // Статистика работы стратегии (пустая строка, если сказать нечего)
+    virtual std::string report() const { return std::string(); }
+};
+
+// Случайная необстрелянная клетка (как EnemyAttack)
+class RandomOpponent : public Opponent {
+public:
+    const char* name() const override { return "random"; }
+    int chooseShot(const Board& board, Rng& rng) override;
+};
+
+// Стратегия по имени: "random", "hunt", "montecarlo" или "montecarlo:MS"
+// (MS - время на ход в миллисекундах, по умолчанию 5), к любой можно добавить
+// "+book" - дебютная книга и затем "+endgame[:LAYOUTS]" - точный перебор в конце партии.
+// nullptr, если такой нет
+std::unique_ptr<Opponent> makeOpponent(const std::string& name);
+// То же, но сложные стратегии считают на пуле pool (nullptr - только в вызывающем потоке)
+class ThreadPool;
+std::unique_ptr<Opponent> makeOpponent(const std::string& name, ThreadPool* pool);
+// Имена всех стратегий через запятую (для справки)
+const char* opponentNames();
+
+// Ход компьютера: выстрел в клетку, выбранную стратегией (как EnemyAttack)
+bool opponentAttack(Board& grid, Opponent& opponent, Rng& rng);
@@ -0,0 +1,59 @@
+#include "Placements.h"
+
+namespace {
+
+// Маски берутся из таблиц классических правил; списки накрытия тоже строятся при компиляции
+constexpr void addPlacement(PlacementTable& table, int length, bool horizontal, int x, int y) {
+    Placement& p = table.items[table.count];
+    const ClassicRules::Placement* fixed = ClassicRules::placement(length, horizontal, x, y);
+    p.mask = fixed->mask;
+    p.halo = fixed->halo;
+    p.length = length;
+    p.horizontal = horizontal;
+    p.x = x;
+    p.y = y;
+    for (int i = 0; i < length; ++i) {
+        int cell = cellIndex(x + (horizontal ? i : 0), y + (horizontal ? 0 : i));
+        p.cells[i] = cell;
+        table.cover[cell][table.coverCount[cell]++] = static_cast<short>(table.count);
+    }
+    table.count++;
+}
+
+constexpr PlacementTable buildTable(int length) {
+    PlacementTable table = {};
+    for (int x = 0; x + length <= BOARD_SIZE; ++x) {
+        for (int y = 0; y < BOARD_SIZE; ++y) {
+            addPlacement(table, length, true, x, y);
+        }
+    }
+    // Однопалубный в обеих ориентациях одинаковый
+    if (length > 1) {
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            for (int y = 0; y + length <= BOARD_SIZE; ++y) {
+                addPlacement(table, length, false, x, y);
+            }
+        }
+    }
+    return table;
+}
+
+struct Tables {
+    PlacementTable items[MAX_SHIP_LENGTH];
+};
+
+constexpr Tables buildTables() {
+    Tables tables = {};
+    for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) tables.items[length - 1] = buildTable(length);
+    return tables;
+}
+
+// Готовые таблицы лежат в данных программы: при запуске ничего не строится
+constexpr Tables TABLES = buildTables();
+
+}
+
+// Таблица для длины от 1 до MAX_SHIP_LENGTH
+const PlacementTable& placementTable(int length) {
+    return TABLES.items[length - 1];
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Board.h"
+#include "Rule_set.h"
+
+//-----------// Таблица всех положений кораблей на поле
+
+const int MAX_SHIP_LENGTH = ClassicRules::MAX_SHIP_LENGTH;
+// Больше всего положений у двухпалубного: 9 * 10 по горизонтали и столько же по вертикали
+const int MAX_PLACEMENTS = 2 * (BOARD_SIZE - 1) * BOARD_SIZE;
+// Клетку накрывают не больше length положений в каждой ориентации
+const int MAX_COVER = 2 * MAX_SHIP_LENGTH;
+
+// Одно положение корабля
+struct Placement {
+    Bitboard mask;   // клетки корабля
+    Bitboard halo;   // клетки корабля вместе с соседями (там не может стоять другой корабль)
+    int cells[MAX_SHIP_LENGTH];
+    int length;
+    bool horizontal;
+    int x, y;
+};
+
+// Все положения кораблей одной длины и списки положений, накрывающих каждую клетку
+struct PlacementTable {
+    Placement items[MAX_PLACEMENTS];
+    int count;
+    short cover[CELL_COUNT][MAX_COVER];
+    int coverCount[CELL_COUNT];
+};
+
+// Таблица для длины от 1 до MAX_SHIP_LENGTH (построена при компиляции)
+const PlacementTable& placementTable(int length);
@@ -0,0 +1,177 @@
+#include "Replay.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char REPLAY_MAGIC[8] = { 'S', 'B', 'R', 'E', 'P', 'L', 'Y', '1' };
+const uint8_t GAME_TAG = 'G';
+
+void putBytes(std::vector<uint8_t>& out, uint64_t value, int count) {
+    for (int i = 0; i < count; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+uint64_t getBytes(const uint8_t* in, int count) {
+    uint64_t value = 0;
+    for (int i = 0; i < count; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+void putFleet(std::vector<uint8_t>& out, const Bitboard& ships) {
+    uint8_t bytes[BITBOARD_BYTES];
+    packBitboard(ships, bytes);
+    out.insert(out.end(), bytes, bytes + BITBOARD_BYTES);
+}
+
+}
+
+// Проверка флота: корабли по составу FLEET, прямые и не касаются друг друга
+bool isValidFleet(const Bitboard& ships) {
+    int expected[MAX_SHIP_LENGTH + 1] = {};
+    for (int length : FLEET) expected[length]++;
+    Bitboard rest = ships;
+    while (rest.any()) {
+        Bitboard ship = connectedCells(rest.lowest(), ships);
+        rest = rest & ~ship;
+        int length = ship.count();
+        if (length > MAX_SHIP_LENGTH || --expected[length] < 0) return false;
+        // Прямой: все клетки в одном столбце (x) или в одной строке (y)
+        int first = ship.lowest();
+        bool sameX = true;
+        bool sameY = true;
+        for (Bitboard cells = ship; cells.any(); cells.reset(cells.lowest())) {
+            int cell = cells.lowest();
+            sameX = sameX && cell / BOARD_SIZE == first / BOARD_SIZE;
+            sameY = sameY && cell % BOARD_SIZE == first % BOARD_SIZE;
+        }
+        if (!sameX && !sameY) return false;
+        // Не касается других кораблей даже углом
+        if ((dilate8(ship) & ships & ~ship).any()) return false;
+    }
+    for (int length = 1; length <= MAX_SHIP_LENGTH; ++length) {
+        if (expected[length] != 0) return false;
+    }
+    return true;
+}
+
+// Переиграть партию по правилам игры и сравнить счёт
+ReplayCheck verifyReplay(const Replay& replay) {
+    ReplayCheck check = { ReplayVerdict::Valid, 0, -1 };
+    if (!isValidFleet(replay.fleets[0]) || !isValidFleet(replay.fleets[1])) {
+        check.verdict = ReplayVerdict::BadFleet;
+        return check;
+    }
+    Board boards[2];
+    boards[0].ships = replay.fleets[0];
+    boards[1].ships = replay.fleets[1];
+    int shots[2] = { 0, 0 };
+    int side = 0;
+    for (uint8_t cell : replay.shots) {
+        // side стреляет по полю соперника, пока попадает
+        Board& target = boards[1 - side];
+        if (check.winner >= 0 || cell >= CELL_COUNT || target.shot().test(cell)) {
+            check.verdict = ReplayVerdict::BadShot;
+            return check;
+        }
+        bool hit = shootCell(target, cell);
+        shots[side]++;
+        surroundSunkShips(target);
+        if (!CheckShip(target)) check.winner = side;
+        else if (!hit) side = 1 - side;
+    }
+    if (check.winner < 0) {
+        check.verdict = ReplayVerdict::Unfinished;
+        return check;
+    }
+    check.score = 100 - shots[0] + ChangScore(boards[0], boards[1]);
+    if (check.score != replay.score) check.verdict = ReplayVerdict::ScoreMismatch;
+    return check;
+}
+
+const char* verdictName(ReplayVerdict verdict) {
+    switch (verdict) {
+    case ReplayVerdict::Valid: return "valid";
+    case ReplayVerdict::BadFleet: return "bad fleet";
+    case ReplayVerdict::BadShot: return "bad shot";
+    case ReplayVerdict::Unfinished: return "unfinished";
+    case ReplayVerdict::ScoreMismatch: return "score mismatch";
+    }
+    return "?";
+}
+
+bool ReplayWriter::open(const std::string& path) {
+    file.open(path, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file for writing: " << path << std::endl;
+        return false;
+    }
+    // Новый файл начинается с заголовка
+    file.seekp(0, std::ios::end);
+    if (file.tellp() == std::streampos(0)) file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    return static_cast<bool>(file);
+}
+
+bool ReplayWriter::write(const Replay& replay) {
+    if (!file.is_open() || replay.shots.size() > 255) return false;
+    size_t nameLength = replay.name.size() < 255 ? replay.name.size() : 255;
+    buffer.clear();
+    buffer.push_back(GAME_TAG);
+    putBytes(buffer, replay.seed, 8);
+    putBytes(buffer, static_cast<uint32_t>(replay.score), 4);
+    buffer.push_back(static_cast<uint8_t>(nameLength));
+    buffer.insert(buffer.end(), replay.name.begin(), replay.name.begin() + nameLength);
+    putFleet(buffer, replay.fleets[0]);
+    putFleet(buffer, replay.fleets[1]);
+    buffer.push_back(static_cast<uint8_t>(replay.shots.size()));
+    buffer.insert(buffer.end(), replay.shots.begin(), replay.shots.end());
+    // Партия уходит в файл одним куском, чтобы при падении обрывалась только последняя
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+bool ReplayReader::open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << path << std::endl;
+        return false;
+    }
+    char magic[sizeof(REPLAY_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "Not a replay file: " << path << std::endl;
+        broken = true;
+        return false;
+    }
+    return true;
+}
+
+// Следующая партия; false - файл кончился или испорчен
+bool ReplayReader::next(Replay& replay) {
+    uint8_t head[1 + 8 + 4 + 1];
+    file.read(reinterpret_cast<char*>(head), sizeof(head));
+    if (file.gcount() == 0) return false;
+    if (file.gcount() != static_cast<std::streamsize>(sizeof(head)) || head[0] != GAME_TAG) {
+        broken = true;
+        return false;
+    }
+    replay.seed = getBytes(head + 1, 8);
+    replay.score = static_cast<int32_t>(static_cast<uint32_t>(getBytes(head + 9, 4)));
+    replay.name.resize(head[13]);
+
+    uint8_t fleets[2 * BITBOARD_BYTES + 1];
+    if (!replay.name.empty()) file.read(&replay.name[0], static_cast<std::streamsize>(replay.name.size()));
+    file.read(reinterpret_cast<char*>(fleets), sizeof(fleets));
+    if (!file) {
+        broken = true;
+        return false;
+    }
+    replay.fleets[0] = unpackBitboard(fleets);
+    replay.fleets[1] = unpackBitboard(fleets + BITBOARD_BYTES);
+    replay.shots.resize(fleets[2 * BITBOARD_BYTES]);
+    if (!replay.shots.empty()) file.read(reinterpret_cast<char*>(replay.shots.data()), static_cast<std::streamsize>(replay.shots.size()));
+    if (!file) {
+        broken = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Rules.h"
+
+//-----------// Запись партий и их проверка
+
+// Файл записей - заголовок и партии подряд, так что его можно дописывать и читать
+// по одной партии, не загружая целиком. Партия: зерно генератора, имя и заявленный
+// счёт, оба флота по 13 байт (100 бит) и выстрелы по одному байту - номеру клетки.
+// Чей выстрел, не хранится: первым стреляет игрок, и ход переходит после промаха.
+// Числа записываются в порядке little-endian.
+struct Replay {
+    uint64_t seed = 0;          // состояние генератора в начале партии
+    std::string name;           // имя из таблицы лидеров (пустое, если не вводилось)
+    int32_t score = 0;          // заявленный счёт
+    Bitboard fleets[2];         // [0] - флот игрока, [1] - флот компьютера
+    std::vector<uint8_t> shots; // все выстрелы обеих сторон по порядку
+};
+
+enum class ReplayVerdict {
+    Valid,
+    BadFleet,           // флот не по правилам
+    BadShot,            // выстрел вне поля, повторный или после конца партии
+    Unfinished,         // выстрелы кончились раньше партии
+    ScoreMismatch       // партия честная, но счёт не тот
+};
+
+// Итог пересчёта партии
+struct ReplayCheck {
+    ReplayVerdict verdict;
+    int score;          // счёт по правилам игры (если партия доиграна)
+    int winner;         // 0 - игрок, 1 - компьютер, -1 - не доиграна
+};
+
+// Проверка флота: корабли по составу FLEET, прямые и не касаются друг друга
+bool isValidFleet(const Bitboard& ships);
+// Переиграть партию по правилам игры и сравнить счёт (как в Main: 100 - выстрелы игрока + ChangScore)
+ReplayCheck verifyReplay(const Replay& replay);
+const char* verdictName(ReplayVerdict verdict);
+
+// Дописывание партий в файл
+class ReplayWriter {
+public:
+    bool open(const std::string& path);
+    bool write(const Replay& replay);
+
+private:
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+};
+
+// Чтение партий по одной
+class ReplayReader {
+public:
+    bool open(const std::string& path);
+    // Следующая партия; false - файл кончился или испорчен (см. damaged)
+    bool next(Replay& replay);
+    bool damaged() const { return broken; }
+
+private:
+    std::ifstream file;
+    bool broken = false;
+};
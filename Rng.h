@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+// Генератор случайных чисел (splitmix64): у каждой партии и каждого потока свой
+struct Rng {
+    uint64_t state;
+
+    explicit Rng(uint64_t seed = 0) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // Равномерное число от 0 до n - 1
+    int below(int n) {
+        return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(n)) >> 32);
+    }
+    // Равномерное число от 0 до 1
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
@@ -0,0 +1,200 @@
+#pragma once
+#include <utility>
+#include "Board.h"
+#include "Rng.h"
+
+//-----------// Правила для поля любого размера и любого состава флота
+
+// Таблицы положений кораблей и маски краёв строятся при компиляции отдельно для каждого
+// варианта правил, поэтому у поля 8x8 (одно слово) и 12x12 (три слова) свой код,
+// а классическая игра 10x10 не платит за то, что вариантов много.
+
+// Одно положение корабля
+template<int Size>
+struct ShipPlacement {
+    BasicBitboard<Size> mask;   // клетки корабля
+    BasicBitboard<Size> halo;   // клетки корабля вместе с соседями (там не может стоять другой корабль)
+};
+
+// Все положения корабля длины Length: сначала горизонтальные (номер x * Size + y),
+// потом вертикальные (номер x * (Size - Length + 1) + y). У однопалубного только первые
+template<int Size, int Length>
+struct ShipPlacements {
+    static constexpr int SPAN = Size - Length + 1;
+    static constexpr int HORIZONTAL = SPAN * Size;
+    static constexpr int COUNT = Length == 1 ? HORIZONTAL : 2 * HORIZONTAL;
+
+    struct Table {
+        ShipPlacement<Size> items[COUNT];
+    };
+
+    static constexpr ShipPlacement<Size> make(int x, int y, bool horizontal) {
+        ShipPlacement<Size> p;
+        for (int i = 0; i < Length; ++i) {
+            p.mask.set((x + (horizontal ? i : 0)) * Size + y + (horizontal ? 0 : i));
+        }
+        p.halo = dilate8(p.mask);
+        return p;
+    }
+
+    static constexpr Table build() {
+        Table table;
+        for (int x = 0; x < SPAN; ++x) {
+            for (int y = 0; y < Size; ++y) table.items[x * Size + y] = make(x, y, true);
+        }
+        if (Length > 1) {
+            for (int x = 0; x < Size; ++x) {
+                for (int y = 0; y < SPAN; ++y) table.items[HORIZONTAL + x * SPAN + y] = make(x, y, false);
+            }
+        }
+        return table;
+    }
+
+    static constexpr Table TABLE = build();
+};
+
+// Положения одной длины без длины в типе
+template<int Size>
+struct PlacementSpan {
+    const ShipPlacement<Size>* items;
+    int count;
+};
+
+template<int Size, int... Lengths>
+struct RuleSet {
+    typedef BasicBitboard<Size> Bitboard;
+    typedef BasicBoard<Size> Board;
+    typedef ShipPlacement<Size> Placement;
+
+    static constexpr int BOARD_SIZE = Size;
+    static constexpr int CELL_COUNT = Size * Size;
+    static constexpr int FLEET_SIZE = sizeof...(Lengths);
+    // Корабли в порядке расстановки, от длинных к коротким
+    static constexpr int FLEET[FLEET_SIZE] = { Lengths... };
+
+    static constexpr int maxLength() {
+        int longest = 0;
+        for (int length : FLEET) longest = length > longest ? length : longest;
+        return longest;
+    }
+    static constexpr int MAX_SHIP_LENGTH = maxLength();
+    static_assert(MAX_SHIP_LENGTH <= Size, "ship does not fit the board");
+
+    // Все положения корабля длины length (1..MAX_SHIP_LENGTH)
+    static PlacementSpan<Size> placements(int length) {
+        return SPANS[length];
+    }
+    // Положение по координатам носа; nullptr, если корабль выходит за поле
+    static constexpr const Placement* placement(int length, bool horizontal, int x, int y) {
+        if (length < 1 || length > MAX_SHIP_LENGTH || x < 0 || y < 0) return nullptr;
+        int span = Size - length + 1;
+        if (length == 1) horizontal = true;
+        if (horizontal ? (x >= span || y >= Size) : (x >= Size || y >= span)) return nullptr;
+        int index = horizontal ? x * Size + y : span * Size + x * span + y;
+        return &SPANS[length].items[index];
+    }
+
+    // Можно ли поставить корабль: он и клетки вокруг свободны от кораблей и выстрелов
+    static bool isValidPlacement(const Placement& p, const Board& board) {
+        return (p.halo & (board.ships | board.shot())).none();
+    }
+
+    // Случайная расстановка всего флота на пустом поле. Каждый корабль выбирается
+    // равномерно среди свободных положений; в тупике расстановка начинается заново
+    static void fillGridWithShips(Board& board, Rng& rng) {
+        for (;;) {
+            Bitboard ships;
+            Bitboard closed;
+            bool placed = true;
+            for (int n = 0; n < FLEET_SIZE && placed; ++n) {
+                const Placement* chosen = choosePlacement(placements(FLEET[n]), closed, rng);
+                if (chosen == nullptr) {
+                    placed = false;
+                    break;
+                }
+                ships |= chosen->mask;
+                closed |= chosen->halo;
+            }
+            if (placed) {
+                board.ships = ships;
+                return;
+            }
+        }
+    }
+
+    // Выстрел по клетке с номером index; true - попадание
+    static bool shootCell(Board& grid, int index) {
+        if (grid.ships.test(index)) {
+            grid.hits.set(index);
+            return true;
+        }
+        grid.misses.set(index);
+        return false;
+    }
+
+    // Случайная клетка среди ещё не обстрелянных
+    static int randomFreeCell(const Board& grid, Rng& rng) {
+        Bitboard freeCells = ~grid.shot();
+        return freeCells.nth(rng.below(freeCells.count()));
+    }
+
+    // Потопленные корабли: ни одной целой клетки рядом. Вокруг них ставятся промахи
+    static void surroundSunkShips(Board& board) {
+        Bitboard unvisited = board.hits & ~board.sunk;
+        Bitboard intact = board.intact();
+        while (unvisited.any()) {
+            Bitboard shipCells = connectedCells(unvisited.lowest(), unvisited);
+            unvisited = unvisited & ~shipCells;
+            Bitboard around = dilate8(shipCells);
+            if ((around & intact).none()) {
+                board.misses |= around & ~board.ships;
+                board.sunk |= shipCells;
+            }
+        }
+    }
+
+    // Остались ли целые корабли
+    static bool CheckShip(const Board& grid) {
+        return grid.intact().any();
+    }
+
+    // Разница попаданий, по 10 очков за клетку
+    static int ChangScore(const Board& grid, const Board& enemy_field) {
+        return (enemy_field.hits.count() - grid.hits.count()) * 10;
+    }
+
+private:
+    // Пока поле свободно, случайное положение почти всегда подходит; иначе один проход по таблице
+    static const Placement* choosePlacement(PlacementSpan<Size> span, const Bitboard& closed, Rng& rng) {
+        for (int probe = 0; probe < 8; ++probe) {
+            const Placement& p = span.items[rng.below(span.count)];
+            if ((p.mask & closed).none()) return &p;
+        }
+        int free = 0;
+        for (int i = 0; i < span.count; ++i) free += (span.items[i].mask & closed).none();
+        if (free == 0) return nullptr;
+        int pick = rng.below(free);
+        for (int i = 0; i < span.count; ++i) {
+            if ((span.items[i].mask & closed).none() && pick-- == 0) return &span.items[i];
+        }
+        return nullptr;
+    }
+
+    // Таблицы всех длин 1..MAX_SHIP_LENGTH; нулевая пустая, чтобы длина была номером
+    struct Spans {
+        PlacementSpan<Size> items[MAX_SHIP_LENGTH + 1];
+        constexpr const PlacementSpan<Size>& operator[](int length) const { return items[length]; }
+    };
+    template<int... Index>
+    static constexpr Spans makeSpans(std::integer_sequence<int, Index...>) {
+        return { { { nullptr, 0 },
+                   { ShipPlacements<Size, Index + 1>::TABLE.items, ShipPlacements<Size, Index + 1>::COUNT }... } };
+    }
+    static constexpr Spans SPANS = makeSpans(std::make_integer_sequence<int, MAX_SHIP_LENGTH>());
+};
+
+//-----------// Варианты правил
+
+typedef RuleSet<10, 4, 3, 3, 2, 2, 2, 1, 1, 1, 1> ClassicRules;
+typedef RuleSet<8, 4, 3, 2, 2, 1, 1, 1> SmallRules;
+typedef RuleSet<12, 5, 4, 3, 3, 2, 2, 2, 1, 1, 1, 1> LargeRules;
@@ -0,0 +1,94 @@
+#include "Rules.h"
+#include <iostream>
+
+// Вывод поля (0 - пусто, 1 - корабль, -1 - промах, -2 - попадание)
+void printGrid(const Board& board) {
+    for (int x = 0; x < BOARD_SIZE; ++x) {
+        for (int y = 0; y < BOARD_SIZE; ++y) {
+            Cell cell = cellAt(board, x, y);
+            int value = cell == Cell::Ship ? 1 : cell == Cell::Miss ? -1 : cell == Cell::Hit ? -2 : 0;
+            std::cout << value << "  ";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "--------------------------" << std::endl;
+}
+
+// Проверяет, есть ли целые клетки кораблей вокруг группы подбитых клеток
+bool isShipAdjacent(const Board& board, const Bitboard& shipCells) {
+    return (dilate8(shipCells) & board.intact()).any();
+}
+// Помечает промахами пустые клетки вокруг группы подбитых клеток
+void fillSurroundings(Board& board, const Bitboard& shipCells) {
+    board.misses |= dilate8(shipCells) & ~board.ships;
+}
+// Функция для поиска всех групп подбитых клеток и проверки их окружения
+void surroundSunkShips(Board& board) {
+    ClassicRules::surroundSunkShips(board);
+}
+
+// Клетки корабля на битовой доске (пустая доска, если корабль выходит за поле)
+Bitboard shipMask(const Ship& ship) {
+    const ClassicRules::Placement* p = ClassicRules::placement(ship.length, ship.horizontal, ship.x, ship.y);
+    return p != nullptr ? p->mask : Bitboard();
+}
+// Проверка возможности размещения корабля: одно AND ореола из таблицы с занятыми клетками
+bool isValidPlacement(const Ship& ship, const Board& board) {
+    const ClassicRules::Placement* p = ClassicRules::placement(ship.length, ship.horizontal, ship.x, ship.y);
+    return p != nullptr && ClassicRules::isValidPlacement(*p, board);
+}
+// Сколько положений корабля длины length ещё можно занять
+int countValidPlacements(int length, const Board& board) {
+    PlacementSpan<BOARD_SIZE> span = ClassicRules::placements(length);
+    int count = 0;
+    for (int i = 0; i < span.count; ++i) count += ClassicRules::isValidPlacement(span.items[i], board);
+    return count;
+}
+// Размещение корабля
+void placeShip(const Ship& ship, Board& board) {
+    board.ships |= shipMask(ship);
+}
+// Заполнение поля противника (поле должно быть пустым)
+void fillGridWithShips(Board& board, Rng& rng, SamplerMode mode) {
+    static const FleetConstraints emptyBoard = constraintsFromBoard(Board());
+    Bitboard ships;
+    // В быстром режиме тупик почти не встречается, точный на пустом поле не ошибается
+    while (!sampleFleet(emptyBoard, rng, ships, mode, 1 << 16)) {
+    }
+    board.ships = ships;
+}
+
+// Выстрел по клетке с номером index
+bool shootCell(Board& grid, int index) {
+    return ClassicRules::shootCell(grid, index);
+}
+// Выстрел играка
+bool handleShooting(Board& grid, int cursorX, int cursorY) {
+    return shootCell(grid, cellIndex(cursorX, cursorY));
+}
+// Проверка перед выстрелом играка
+bool CheckHandleShooting(const Board& grid, int cursorX, int cursorY) {
+    return !grid.shot().test(cellIndex(cursorX, cursorY));
+}
+// Случайная клетка среди ещё не обстрелянных, без повторных попыток
+int randomFreeCell(const Board& grid, Rng& rng) {
+    return ClassicRules::randomFreeCell(grid, rng);
+}
+// Атака апонента
+bool EnemyAttack(Board& grid, Rng& rng) {
+    return shootCell(grid, randomFreeCell(grid, rng));
+}
+
+// Изменение счёта
+int ChangScore(const Board& grid, const Board& enemy_field) {
+    return ClassicRules::ChangScore(grid, enemy_field);
+}
+// Проверка на целые корабли
+bool CheckShip(const Board& grid) {
+    return ClassicRules::CheckShip(grid);
+}
+
+// Обнуление поля
+void ArrowReset(Board& grid) {
+    grid = Board();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Board.h"
+#include "Rng.h"
+#include "Fleet_sampler.h"
+#include "Rule_set.h"
+
+//-----------// Правила игры (без SDL)
+
+// Состав флота: длины кораблей в порядке размещения (классические правила)
+const int FLEET_SIZE = ClassicRules::FLEET_SIZE;
+static constexpr const int (&FLEET)[FLEET_SIZE] = ClassicRules::FLEET;
+
+struct Ship {
+    int x, y, length;
+    bool horizontal;
+    Ship(int l) : x(0), y(0), length(l), horizontal(true) {}
+
+    void rotate() {
+        horizontal = !horizontal;
+    }
+};
+
+// Вывод поля (0 - пусто, 1 - корабль, -1 - промах, -2 - попадание)
+void printGrid(const Board& board);
+
+// Проверяет, есть ли целые клетки кораблей вокруг группы подбитых клеток
+bool isShipAdjacent(const Board& board, const Bitboard& shipCells);
+// Помечает промахами пустые клетки вокруг группы подбитых клеток
+void fillSurroundings(Board& board, const Bitboard& shipCells);
+// Функция для поиска всех групп подбитых клеток и проверки их окружения
+void surroundSunkShips(Board& board);
+
+// Клетки корабля на битовой доске (пустая доска, если корабль выходит за поле)
+Bitboard shipMask(const Ship& ship);
+// Проверка возможности размещения корабля
+bool isValidPlacement(const Ship& ship, const Board& board);
+// Сколько положений корабля длины length ещё можно занять (для подсказки при размещении)
+int countValidPlacements(int length, const Board& board);
+// Размещение корабля
+void placeShip(const Ship& ship, Board& board);
+// Заполнение поля противника (поле должно быть пустым)
+void fillGridWithShips(Board& board, Rng& rng, SamplerMode mode = SamplerMode::Fast);
+
+// Выстрел по клетке с номером index
+bool shootCell(Board& grid, int index);
+// Выстрел играка
+bool handleShooting(Board& grid, int cursorX, int cursorY);
+// Проверка перед выстрелом играка
+bool CheckHandleShooting(const Board& grid, int cursorX, int cursorY);
+// Случайная клетка среди ещё не обстрелянных
+int randomFreeCell(const Board& grid, Rng& rng);
+// Атака апонента
+bool EnemyAttack(Board& grid, Rng& rng);
+
+// Изменение счёта
+int ChangScore(const Board& grid, const Board& enemy_field);
+// Проверка на целые корабли
+bool CheckShip(const Board& grid);
+// Обнуление поля
+void ArrowReset(Board& grid);
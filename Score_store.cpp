@@ -0,0 +1,353 @@
+#include "Score_store.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <queue>
+
+namespace {
+
+const char FILE_MAGIC[8] = { 'S', 'B', 'S', 'C', 'O', 'R', 'E', '1' };
+// Версия 2: в ячейке игрока номер его последнего учтённого результата
+const char INDEX_MAGIC[8] = { 'S', 'B', 'I', 'N', 'D', 'E', 'X', '2' };
+const uint32_t FILE_VERSION = 1;
+const uint64_t INITIAL_RECORDS = 1024;
+const uint64_t INITIAL_BUCKETS = 1024;
+
+// Имя в поле фиксированной длины: обрезается по границе символа UTF-8, хвост - нули
+void packName(const std::string& name, char* field) {
+    size_t length = name.size();
+    if (length > SCORE_NAME_BYTES - 1) {
+        length = SCORE_NAME_BYTES - 1;
+        while (length > 0 && (static_cast<unsigned char>(name[length]) & 0xC0) == 0x80) --length;
+    }
+    std::memset(field, 0, SCORE_NAME_BYTES);
+    std::memcpy(field, name.data(), length);
+}
+
+std::string unpackName(const char* field) {
+    size_t length = 0;
+    while (length < static_cast<size_t>(SCORE_NAME_BYTES) && field[length] != 0) ++length;
+    return std::string(field, length);
+}
+
+// FNV-1a по полю имени
+uint64_t hashName(const char* field) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (int i = 0; i < SCORE_NAME_BYTES; ++i) {
+        hash ^= static_cast<unsigned char>(field[i]);
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+}
+
+struct ScoreStore::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t topCapacity;
+    uint32_t topCount;          // сколько записей в разделе лучших
+    uint32_t reserved;
+    uint64_t recordCount;       // сколько результатов записано
+    uint64_t recordCapacity;    // на сколько результатов хватает файла
+    uint64_t topThrough;        // сколько первых результатов учтено в разделе лучших
+    uint64_t padding[2];
+};
+
+struct ScoreStore::IndexHeader {
+    char magic[8];
+    uint64_t bucketCount;       // степень двойки
+    uint64_t used;
+    uint64_t indexedRecords;    // сколько первых результатов учтено в индексе
+};
+
+struct ScoreStore::PlayerSlot {
+    char name[SCORE_NAME_BYTES];    // пустое имя - свободная ячейка
+    int32_t best;
+    uint32_t games;
+    int64_t total;
+    uint64_t applied;           // номер последнего учтённого результата + 1 (0 - ни одного)
+};
+
+static_assert(sizeof(ScoreRecord) == 36, "ScoreRecord layout");
+static_assert(sizeof(ScoreStore::FileHeader) == 64, "FileHeader layout");
+static_assert(sizeof(ScoreStore::PlayerSlot) == 56, "PlayerSlot layout");
+
+namespace {
+
+size_t recordsOffset() {
+    return sizeof(ScoreStore::FileHeader) + TOP_CAPACITY * sizeof(ScoreRecord);
+}
+
+size_t dataSize(uint64_t recordCapacity) {
+    return recordsOffset() + static_cast<size_t>(recordCapacity) * sizeof(ScoreRecord);
+}
+
+size_t indexSize(uint64_t bucketCount) {
+    return sizeof(ScoreStore::IndexHeader) + static_cast<size_t>(bucketCount) * sizeof(ScoreStore::PlayerSlot);
+}
+
+}
+
+ScoreStore::~ScoreStore() {
+    close();
+}
+
+ScoreStore::FileHeader* ScoreStore::header() const {
+    return reinterpret_cast<FileHeader*>(const_cast<unsigned char*>(data.data()));
+}
+
+ScoreRecord* ScoreStore::topRecords() const {
+    return reinterpret_cast<ScoreRecord*>(const_cast<unsigned char*>(data.data()) + sizeof(FileHeader));
+}
+
+ScoreRecord* ScoreStore::records() const {
+    return reinterpret_cast<ScoreRecord*>(const_cast<unsigned char*>(data.data()) + recordsOffset());
+}
+
+ScoreStore::IndexHeader* ScoreStore::indexHeader() const {
+    return reinterpret_cast<IndexHeader*>(const_cast<unsigned char*>(index.data()));
+}
+
+ScoreStore::PlayerSlot* ScoreStore::slots() const {
+    return reinterpret_cast<PlayerSlot*>(const_cast<unsigned char*>(index.data()) + sizeof(IndexHeader));
+}
+
+// Открыть или создать файл; дописанное после прошлого закрытия доучитывается
+bool ScoreStore::open(const std::string& filePath) {
+    close();
+    path = filePath;
+    if (!data.openWrite(path, dataSize(INITIAL_RECORDS))) return false;
+
+    FileHeader* h = header();
+    static const char zero[8] = {};
+    if (std::memcmp(h->magic, zero, sizeof(zero)) == 0 && h->recordCount == 0) {
+        // Новый файл
+        std::memcpy(h->magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        h->version = FILE_VERSION;
+        h->topCapacity = TOP_CAPACITY;
+        h->recordCapacity = INITIAL_RECORDS;
+    }
+    if (std::memcmp(h->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || h->version != FILE_VERSION ||
+        h->topCapacity != TOP_CAPACITY || h->recordCount > h->recordCapacity ||
+        data.size() < dataSize(h->recordCapacity)) {
+        std::cerr << "Not a score file or damaged: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    // Раздел лучших отстал от записей (падение посреди add) - доучитываем
+    if (h->topThrough > h->recordCount || h->topCount > TOP_CAPACITY) {
+        h->topThrough = 0;
+        h->topCount = 0;
+    }
+    for (uint64_t i = h->topThrough; i < h->recordCount; ++i) {
+        insertTop(records()[i]);
+        h->topThrough = i + 1;
+    }
+    return openIndex();
+}
+
+void ScoreStore::close() {
+    flush();
+    index.close();
+    data.close();
+}
+
+// Сбросить изменения на диск
+bool ScoreStore::flush() {
+    bool saved = data.flush();
+    return index.flush() && saved;
+}
+
+bool ScoreStore::growRecords() {
+    uint64_t capacity = header()->recordCapacity * 2;
+    data.close();
+    if (!data.openWrite(path, dataSize(capacity))) return false;
+    header()->recordCapacity = capacity;
+    return true;
+}
+
+// Вставить результат в раздел лучших (при равенстве очков новый идёт после старых)
+void ScoreStore::insertTop(const ScoreRecord& record) {
+    FileHeader* h = header();
+    ScoreRecord* top = topRecords();
+    uint32_t position = h->topCount;
+    while (position > 0 && top[position - 1].score < record.score) --position;
+    if (position >= TOP_CAPACITY) return;
+    uint32_t last = h->topCount < TOP_CAPACITY ? h->topCount : TOP_CAPACITY - 1;
+    std::memmove(top + position + 1, top + position, (last - position) * sizeof(ScoreRecord));
+    top[position] = record;
+    if (h->topCount < TOP_CAPACITY) h->topCount++;
+}
+
+bool ScoreStore::add(const std::string& name, int score) {
+    if (!data.isOpen() || name.empty()) return false;
+    if (header()->recordCount == header()->recordCapacity && !growRecords()) return false;
+
+    // Сначала сама запись, потом счётчик: недописанная запись не будет видна
+    FileHeader* h = header();
+    ScoreRecord record;
+    packName(name, record.name);
+    record.score = score;
+    records()[h->recordCount] = record;
+    h->recordCount++;
+
+    insertTop(record);
+    h->topThrough = h->recordCount;
+    if (!indexRecord(record, h->recordCount - 1)) return false;
+    indexHeader()->indexedRecords = h->recordCount;
+    return true;
+}
+
+std::vector<std::string> ScoreStore::top(size_t count) const {
+    std::vector<std::string> lines;
+    for (const ScoreEntry& entry : best(count)) {
+        lines.push_back(entry.name + " " + std::to_string(entry.score));
+    }
+    return lines;
+}
+
+// Лучшие count результатов
+std::vector<ScoreEntry> ScoreStore::best(size_t count) const {
+    std::vector<ScoreEntry> result;
+    if (!data.isOpen()) return result;
+    const FileHeader* h = header();
+    if (count <= h->topCount || h->recordCount <= h->topCount) {
+        size_t n = count < h->topCount ? count : h->topCount;
+        for (size_t i = 0; i < n; ++i) {
+            result.push_back({ unpackName(topRecords()[i].name), topRecords()[i].score });
+        }
+        return result;
+    }
+
+    // Проход по всем записям: в куче count лучших, наверху худший из них
+    typedef std::pair<int32_t, uint64_t> Item;     // очки, номер записи
+    auto better = [](const Item& a, const Item& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+    std::priority_queue<Item, std::vector<Item>, decltype(better)> heap(better);
+    const ScoreRecord* all = records();
+    for (uint64_t i = 0; i < h->recordCount; ++i) {
+        Item item(all[i].score, i);
+        if (heap.size() < count) heap.push(item);
+        else if (better(item, heap.top())) {
+            heap.pop();
+            heap.push(item);
+        }
+    }
+    result.resize(heap.size());
+    for (size_t i = heap.size(); i > 0; --i) {
+        const ScoreRecord& record = all[heap.top().second];
+        result[i - 1] = { unpackName(record.name), record.score };
+        heap.pop();
+    }
+    return result;
+}
+
+uint64_t ScoreStore::size() const {
+    return data.isOpen() ? header()->recordCount : 0;
+}
+
+bool ScoreStore::openIndex() {
+    std::string indexPath = path + ".idx";
+    if (!index.openWrite(indexPath, indexSize(INITIAL_BUCKETS))) return false;
+
+    IndexHeader* h = indexHeader();
+    bool fresh = h->bucketCount == 0 && h->used == 0 && h->indexedRecords == 0;
+    bool valid = std::memcmp(h->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+                 h->bucketCount >= INITIAL_BUCKETS && (h->bucketCount & (h->bucketCount - 1)) == 0 &&
+                 index.size() >= indexSize(h->bucketCount) && h->used < h->bucketCount &&
+                 h->indexedRecords <= header()->recordCount;
+    if (!valid) {
+        // Индекс от другого файла или повреждён - собираем заново по записям
+        if (!fresh) std::cerr << "Rebuilding player index: " << indexPath << std::endl;
+        index.close();
+        std::remove(indexPath.c_str());
+        if (!index.openWrite(indexPath, indexSize(INITIAL_BUCKETS))) return false;
+        h = indexHeader();
+        std::memcpy(h->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        h->bucketCount = INITIAL_BUCKETS;
+    }
+    for (uint64_t i = indexHeader()->indexedRecords; i < header()->recordCount; ++i) {
+        if (!indexRecord(records()[i], i)) return false;
+        indexHeader()->indexedRecords = i + 1;
+    }
+    return true;
+}
+
+// Переложить игроков в таблицу из bucketCount ячеек (новый файл подменяет старый)
+bool ScoreStore::rebuildIndex(uint64_t bucketCount) {
+    std::string indexPath = path + ".idx";
+    std::string tempPath = indexPath + ".tmp";
+    std::remove(tempPath.c_str());
+    {
+        MappedFile next;
+        if (!next.openWrite(tempPath, indexSize(bucketCount))) return false;
+        IndexHeader* target = reinterpret_cast<IndexHeader*>(next.data());
+        PlayerSlot* targetSlots = reinterpret_cast<PlayerSlot*>(next.data() + sizeof(IndexHeader));
+        const IndexHeader* source = indexHeader();
+        *target = *source;
+        target->bucketCount = bucketCount;
+        const PlayerSlot* sourceSlots = slots();
+        for (uint64_t i = 0; i < source->bucketCount; ++i) {
+            if (sourceSlots[i].name[0] == 0) continue;
+            *findSlot(targetSlots, bucketCount, sourceSlots[i].name) = sourceSlots[i];
+        }
+        if (!next.flush()) return false;
+    }
+    index.close();
+    if (!replaceFile(tempPath, indexPath)) {
+        std::cerr << "Failed to replace " << indexPath << std::endl;
+        return false;
+    }
+    return index.openWrite(indexPath, indexSize(bucketCount));
+}
+
+// Ячейка игрока или свободная ячейка, где он должен лежать
+ScoreStore::PlayerSlot* ScoreStore::findSlot(PlayerSlot* table, uint64_t bucketCount, const char* name) const {
+    uint64_t mask = bucketCount - 1;
+    for (uint64_t i = hashName(name) & mask;; i = (i + 1) & mask) {
+        if (table[i].name[0] == 0 || std::memcmp(table[i].name, name, SCORE_NAME_BYTES) == 0) return &table[i];
+    }
+}
+
+// Учесть результат номер number. Повторно он не учитывается: если программа упала
+// между индексом и счётчиком indexedRecords, при следующем открытии он пропустится
+bool ScoreStore::indexRecord(const ScoreRecord& record, uint64_t number) {
+    PlayerSlot* slot = findSlot(slots(), indexHeader()->bucketCount, record.name);
+    if (slot->name[0] == 0) {
+        // Заполнено больше чем на 70% - таблица удваивается
+        IndexHeader* h = indexHeader();
+        if ((h->used + 1) * 10 > h->bucketCount * 7) {
+            if (!rebuildIndex(h->bucketCount * 2)) return false;
+            slot = findSlot(slots(), indexHeader()->bucketCount, record.name);
+        }
+        std::memcpy(slot->name, record.name, SCORE_NAME_BYTES);
+        slot->best = record.score;
+        slot->games = 0;
+        slot->total = 0;
+        slot->applied = 0;
+        indexHeader()->used++;
+    }
+    if (number < slot->applied) return true;
+    if (record.score > slot->best) slot->best = record.score;
+    slot->games++;
+    slot->total += record.score;
+    slot->applied = number + 1;
+    return true;
+}
+
+// Сводка по игроку; false, если такого нет
+bool ScoreStore::player(const std::string& name, PlayerStats& stats) const {
+    if (!index.isOpen() || name.empty()) return false;
+    char field[SCORE_NAME_BYTES];
+    packName(name, field);
+    const PlayerSlot* slot = findSlot(slots(), indexHeader()->bucketCount, field);
+    if (slot->name[0] == 0) return false;
+    stats.name = unpackName(slot->name);
+    stats.best = slot->best;
+    stats.games = slot->games;
+    stats.total = slot->total;
+    return true;
+}
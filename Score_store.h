@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Leaderboard.h"
+#include "Mapped_file.h"
+
+//-----------// Двоичная таблица лидеров для очень больших файлов
+
+// Файл отображается в память: заголовок, раздел из TOP_CAPACITY лучших результатов
+// (по убыванию) и все результаты в порядке поступления. Для первой дюжины читаются
+// только заголовок и раздел лучших, хвост не разбирается, поэтому время запуска и
+// занятая память не растут вместе с файлом. Рядом лежит файл ".idx" - хеш-таблица
+// игроков (лучший результат, число игр, сумма очков и номер последнего
+// учтённого результата, чтобы ни один не учёлся дважды), тоже отображённая в память.
+// Числа хранятся в порядке байтов машины.
+const int SCORE_NAME_BYTES = 32;    // имя в UTF-8, дополненное нулями
+const int TOP_CAPACITY = 64;
+
+struct ScoreRecord {
+    char name[SCORE_NAME_BYTES];
+    int32_t score;
+};
+
+// Сводка по одному игроку
+struct PlayerStats {
+    std::string name;
+    int best = 0;
+    uint32_t games = 0;
+    int64_t total = 0;
+
+    double average() const { return games > 0 ? static_cast<double>(total) / games : 0; }
+};
+
+class ScoreStore : public ScoreBoard {
+public:
+    ~ScoreStore();
+
+    // Открыть или создать файл; дописанное после прошлого закрытия доучитывается
+    bool open(const std::string& path);
+    void close();
+    // Сбросить изменения на диск
+    bool flush();
+
+    bool add(const std::string& name, int score) override;
+    std::vector<std::string> top(size_t count) const override;
+    // Лучшие count результатов. Больше TOP_CAPACITY - проход по всему файлу с кучей из count записей
+    std::vector<ScoreEntry> best(size_t count) const;
+    // Сводка по игроку; false, если такого нет
+    bool player(const std::string& name, PlayerStats& stats) const;
+    uint64_t size() const;
+
+    // Разметка файлов (определена в Score_store.cpp)
+    struct FileHeader;
+    struct IndexHeader;
+    struct PlayerSlot;
+
+private:
+    FileHeader* header() const;
+    ScoreRecord* topRecords() const;
+    ScoreRecord* records() const;
+    IndexHeader* indexHeader() const;
+    PlayerSlot* slots() const;
+
+    bool growRecords();
+    void insertTop(const ScoreRecord& record);
+    bool openIndex();
+    bool rebuildIndex(uint64_t bucketCount);
+    PlayerSlot* findSlot(PlayerSlot* table, uint64_t bucketCount, const char* name) const;
+    bool indexRecord(const ScoreRecord& record, uint64_t number);
+
+    std::string path;
+    MappedFile data;
+    MappedFile index;
+};
@@ -0,0 +1,135 @@
+#include "Self_play.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Allocation_counter.h"
+#include "Batch_engine.h"
+
+AiGame::AiGame(Opponent& first, Opponent& second)
+    : players{ &first, &second } {
+}
+
+// Новая партия: обе стороны расставляют флот
+void AiGame::start(Rng& rng, SamplerMode fleets) {
+    players[0]->reset();
+    players[1]->reset();
+    boards[0] = Board();
+    boards[1] = Board();
+    fillGridWithShips(boards[0], rng, fleets);
+    fillGridWithShips(boards[1], rng, fleets);
+    current = { 0, { 0, 0 } };
+    side = 0;
+    lastCell = -1;
+    done = false;
+}
+
+// Один выстрел по правилам игры; true, если партия закончилась
+bool AiGame::step(Rng& rng) {
+    if (done) return true;
+    // side стреляет по полю соперника, пока попадает
+    Board& target = boards[1 - side];
+    lastCell = players[side]->chooseShot(target, rng);
+    bool hit = shootCell(target, lastCell);
+    current.shots[side]++;
+    surroundSunkShips(target);
+    if (!CheckShip(target)) {
+        current.winner = side;
+        done = true;
+        return true;
+    }
+    if (!hit) side = 1 - side;
+    return false;
+}
+
+// Сыграть одну партию: обе стороны расставляют флот и стреляют по правилам игры
+GameResult playAiGame(Opponent& first, Opponent& second, Rng& rng, SamplerMode fleets) {
+    AiGame game(first, second);
+    game.start(rng, fleets);
+    while (!game.step(rng)) {
+    }
+    return game.result();
+}
+
+void SelfPlayStats::add(const GameResult& result) {
+    int shots = result.shots[result.winner];
+    if (games == 0 || shots < minShots) minShots = shots;
+    if (games == 0 || shots > maxShots) maxShots = shots;
+    games++;
+    wins[result.winner]++;
+    winnerShots += shots;
+    winnerShotsSq += static_cast<double>(shots) * shots;
+    totalShots += result.shots[0] + result.shots[1];
+}
+
+void SelfPlayStats::merge(const SelfPlayStats& other) {
+    if (other.games == 0) return;
+    for (int side = 0; side < 2; ++side) {
+        if (reports[side].empty()) reports[side] = other.reports[side];
+    }
+    minShots = games == 0 ? other.minShots : std::min(minShots, other.minShots);
+    maxShots = games == 0 ? other.maxShots : std::max(maxShots, other.maxShots);
+    games += other.games;
+    wins[0] += other.wins[0];
+    wins[1] += other.wins[1];
+    winnerShots += other.winnerShots;
+    winnerShotsSq += other.winnerShotsSq;
+    totalShots += other.totalShots;
+    allocations += other.allocations;
+}
+
+// Сыграть серию партий на нескольких потоках
+SelfPlayStats runSelfPlay(const SelfPlayOptions& options) {
+    long long games = options.games;
+    int threads = options.threads;
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (games < threads) threads = static_cast<int>(std::max(1ll, games));
+
+    std::vector<SelfPlayStats> partial(threads);
+    std::vector<std::thread> workers;
+    Rng seeds(options.seed);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        long long count = games / threads + (t < games % threads ? 1 : 0);
+        uint64_t threadSeed = seeds.next();
+        workers.emplace_back([&partial, &options, t, count, threadSeed]() {
+            Rng rng(threadSeed);
+            SelfPlayStats local;
+            if (options.batch) {
+                BatchStats batch;
+                long long allocations = threadAllocationCount();
+                playBatchGames(count, threadSeed, batch);
+                batch.games.allocations = threadAllocationCount() - allocations;
+                partial[t] = batch.games;
+                return;
+            }
+            if (options.boardSize != BOARD_SIZE) {
+                long long allocations = threadAllocationCount();
+                for (long long i = 0; i < count; ++i) {
+                    local.add(options.boardSize < BOARD_SIZE ? playRandomGame<SmallRules>(rng)
+                                                             : playRandomGame<LargeRules>(rng));
+                }
+                local.allocations = threadAllocationCount() - allocations;
+                partial[t] = local;
+                return;
+            }
+            std::unique_ptr<Opponent> a = makeOpponent(options.first);
+            std::unique_ptr<Opponent> b = makeOpponent(options.second);
+            long long allocations = threadAllocationCount();
+            for (long long i = 0; i < count; ++i) {
+                local.add(playAiGame(*a, *b, rng, options.fleets));
+            }
+            local.allocations = threadAllocationCount() - allocations;
+            local.reports[0] = a->report();
+            local.reports[1] = b->report();
+            partial[t] = local;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    SelfPlayStats total;
+    for (const auto& stats : partial) total.merge(stats);
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Opponent.h"
+#include "Rule_set.h"
+
+//-----------// Партии компьютер против компьютера без окна
+
+// Итог одной партии
+struct GameResult {
+    int winner;     // 0 или 1
+    int shots[2];   // сколько выстрелов сделала каждая сторона
+};
+
+// Партия компьютер против компьютера, которую можно играть по одному выстрелу
+class AiGame {
+public:
+    AiGame(Opponent& first, Opponent& second);
+
+    // Новая партия: обе стороны расставляют флот
+    void start(Rng& rng, SamplerMode fleets = SamplerMode::Fast);
+    // Один выстрел по правилам игры; true, если партия закончилась
+    bool step(Rng& rng);
+
+    bool finished() const { return done; }
+    // Поле стороны side (по нему стреляет соперник)
+    const Board& board(int side) const { return boards[side]; }
+    // Чей сейчас выстрел
+    int turn() const { return side; }
+    const GameResult& result() const { return current; }
+    // Клетка последнего выстрела (-1 до первого)
+    int lastShot() const { return lastCell; }
+
+private:
+    Opponent* players[2];
+    Board boards[2];
+    GameResult current = { 0, { 0, 0 } };
+    int side = 0;
+    int lastCell = -1;
+    bool done = false;
+};
+
+// Сыграть одну партию: обе стороны расставляют флот и стреляют по правилам игры
+GameResult playAiGame(Opponent& first, Opponent& second, Rng& rng, SamplerMode fleets = SamplerMode::Fast);
+
+// Партия случайный против случайного по правилам Rules (любое поле и любой флот)
+template<class Rules>
+GameResult playRandomGame(Rng& rng) {
+    typename Rules::Board boards[2];
+    Rules::fillGridWithShips(boards[0], rng);
+    Rules::fillGridWithShips(boards[1], rng);
+    GameResult result = { 0, { 0, 0 } };
+    int side = 0;
+    while (true) {
+        typename Rules::Board& target = boards[1 - side];
+        bool hit = Rules::shootCell(target, Rules::randomFreeCell(target, rng));
+        result.shots[side]++;
+        Rules::surroundSunkShips(target);
+        if (!Rules::CheckShip(target)) {
+            result.winner = side;
+            return result;
+        }
+        if (!hit) side = 1 - side;
+    }
+}
+
+// Сводка по серии партий
+struct SelfPlayStats {
+    long long games = 0;
+    long long wins[2] = { 0, 0 };
+    long long winnerShots = 0;     // сумма выстрелов победителя
+    double winnerShotsSq = 0;      // сумма квадратов (для разброса)
+    long long totalShots = 0;      // сумма выстрелов обеих сторон
+    int minShots = 0;
+    int maxShots = 0;
+    double seconds = 0;
+    long long allocations = 0;     // выделений памяти во время партий (создание стратегий не в счёт)
+    std::string reports[2];        // Opponent::report() обеих сторон
+
+    void add(const GameResult& result);
+    void merge(const SelfPlayStats& other);
+};
+
+// Параметры серии партий
+struct SelfPlayOptions {
+    long long games = 100000;
+    int threads = 0;                        // 0 - по числу ядер
+    uint64_t seed = 0;
+    std::string first = "random";           // стратегии сторон (см. makeOpponent)
+    std::string second = "random";
+    SamplerMode fleets = SamplerMode::Fast; // как расставляется флот
+    int boardSize = BOARD_SIZE;             // 8 и 12 - варианты правил, только для "random"
+    bool batch = false;                     // пакетный движок (только "random" на поле 10x10)
+};
+
+// Сыграть серию партий на нескольких потоках
+SelfPlayStats runSelfPlay(const SelfPlayOptions& options);
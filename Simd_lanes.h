@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+//-----------// Векторы 64-битных слов для пакетного движка
+
+// Каждый тип - несколько независимых 64-битных дорожек (по слову поля на партию) с одним
+// набором операций, так что ядро пакетного движка пишется один раз для всех вариантов.
+// Вариант AVX2 (4 дорожки) лежит в Batch_engine_avx2.cpp: только там разрешены его команды.
+
+// Без векторных команд: одна дорожка
+struct LanesScalar {
+    static constexpr int LANES = 1;
+    uint64_t v;
+
+    static LanesScalar load(const uint64_t* p) { return { *p }; }
+    void store(uint64_t* p) const { *p = v; }
+    static LanesScalar broadcast(uint64_t x) { return { x }; }
+    template<int N> LanesScalar shl() const { return { v << N }; }
+    template<int N> LanesScalar shr() const { return { v >> N }; }
+    LanesScalar operator&(LanesScalar o) const { return { v & o.v }; }
+    LanesScalar operator|(LanesScalar o) const { return { v | o.v }; }
+    // this & ~o
+    LanesScalar andNot(LanesScalar o) const { return { v & ~o.v }; }
+    // Биты дорожек, где слово нулевое
+    int zeroMask() const { return v == 0 ? 1 : 0; }
+};
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_LANES_SSE2
+
+// SSE2: две дорожки
+struct LanesSse2 {
+    static constexpr int LANES = 2;
+    __m128i v;
+
+    static LanesSse2 load(const uint64_t* p) { return { _mm_load_si128(reinterpret_cast<const __m128i*>(p)) }; }
+    void store(uint64_t* p) const { _mm_store_si128(reinterpret_cast<__m128i*>(p), v); }
+    static LanesSse2 broadcast(uint64_t x) {
+        return { _mm_set_epi32(static_cast<int>(x >> 32), static_cast<int>(x), static_cast<int>(x >> 32), static_cast<int>(x)) };
+    }
+    template<int N> LanesSse2 shl() const { return { _mm_slli_epi64(v, N) }; }
+    template<int N> LanesSse2 shr() const { return { _mm_srli_epi64(v, N) }; }
+    LanesSse2 operator&(LanesSse2 o) const { return { _mm_and_si128(v, o.v) }; }
+    LanesSse2 operator|(LanesSse2 o) const { return { _mm_or_si128(v, o.v) }; }
+    LanesSse2 andNot(LanesSse2 o) const { return { _mm_andnot_si128(o.v, v) }; }
+    // В SSE2 нет сравнения 64-битных слов: обе 32-битные половины должны быть нулевыми
+    int zeroMask() const {
+        __m128i halves = _mm_cmpeq_epi32(v, _mm_setzero_si128());
+        __m128i both = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_movemask_pd(_mm_castsi128_pd(both));
+    }
+};
+#endif
@@ -0,0 +1,167 @@
+#include "Spectator_wall.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "Board_renderer.h"
+#include "Self_play.h"
+
+namespace {
+
+const int HEADER_HEIGHT = 60;
+const int FINISHED_FRAMES = 60;     // сколько кадров показывать законченную партию
+
+struct WallGame {
+    std::unique_ptr<Opponent> players[2];
+    std::unique_ptr<AiGame> game;
+    Rng rng;
+    int finishedFrames = 0;
+
+    explicit WallGame(uint64_t seed) : rng(seed) {}
+};
+
+// Размещение плиток: в плитке два поля рядом
+struct WallLayout {
+    int columns;
+    int step;       // шаг между клетками
+    int cellSize;
+    int left;
+    int top;
+};
+
+// Самая крупная сетка плиток, в которую помещаются все партии
+WallLayout layoutWall(int games, int width, int height) {
+    // Плитка - два поля по 10 клеток и зазор в 2 клетки, по высоте поле и зазор в 1 клетку
+    const int TILE_COLUMNS = 2 * BOARD_SIZE + 2;
+    const int TILE_ROWS = BOARD_SIZE + 1;
+    WallLayout layout = { 1, 0, 0, 0, 0 };
+    for (int columns = 1; columns <= games; ++columns) {
+        int rows = (games + columns - 1) / columns;
+        int step = std::min(width / (columns * TILE_COLUMNS), height / (rows * TILE_ROWS));
+        if (step > layout.step) {
+            layout.columns = columns;
+            layout.step = step;
+        }
+    }
+    layout.step = std::max(layout.step, 2);
+    layout.cellSize = layout.step - std::max(1, layout.step / 10);
+    int rows = (games + layout.columns - 1) / layout.columns;
+    layout.left = std::max(0, (width - layout.columns * TILE_COLUMNS * layout.step) / 2);
+    layout.top = std::max(0, (height - rows * TILE_ROWS * layout.step) / 2);
+    return layout;
+}
+
+}
+
+// Настройки из командной строки: --wall N, --ai NAME, --vs NAME, --speed K
+WallOptions parseWallOptions(int argc, char* argv[]) {
+    WallOptions options;
+    bool secondGiven = false;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--wall") == 0) {
+            options.games = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--ai") == 0) {
+            options.first = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--vs") == 0) {
+            options.second = argv[++i];
+            secondGiven = true;
+        }
+        else if (std::strcmp(argv[i], "--speed") == 0) {
+            options.shotsPerFrame = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+    if (!secondGiven) options.second = options.first;
+    return options;
+}
+
+// Показывать стену, пока не закроют окно или не нажмут Esc
+void runSpectatorWall(SDL_Renderer* renderer, TextAtlas& text, const WallOptions& options,
+                      const RenderSettings& settings) {
+    Rng seeds(static_cast<uint64_t>(std::time(nullptr)));
+    std::vector<std::unique_ptr<WallGame>> games;
+    for (int i = 0; i < options.games; ++i) {
+        std::unique_ptr<WallGame> wallGame(new WallGame(seeds.next()));
+        wallGame->players[0] = makeOpponent(options.first);
+        wallGame->players[1] = makeOpponent(options.second);
+        if (!wallGame->players[0] || !wallGame->players[1]) {
+            std::cerr << "Unknown strategy (expected " << opponentNames() << ")" << std::endl;
+            return;
+        }
+        wallGame->game.reset(new AiGame(*wallGame->players[0], *wallGame->players[1]));
+        wallGame->game->start(wallGame->rng);
+        games.push_back(std::move(wallGame));
+    }
+
+    int width = 0;
+    int height = 0;
+    SDL_GetRendererOutputSize(renderer, &width, &height);
+    WallLayout layout = layoutWall(options.games, width, height - HEADER_HEIGHT);
+    layout.top += HEADER_HEIGHT;
+    std::string title = options.first + " vs " + options.second;
+    SDL_Color white = { 255, 255, 255, SDL_ALPHA_OPAQUE };
+
+    BoardRenderer boards;
+    FrameScheduler scheduler(settings);
+    long long played = 0;
+    long long wins[2] = { 0, 0 };
+    bool running = true;
+    while (running) {
+        scheduler.beginPass();
+        SDL_Event event;
+        while (scheduler.nextEvent(event)) {
+            if (event.type == SDL_QUIT) {
+                running = false;
+            }
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
+                running = false;
+            }
+        }
+        if (!running || !scheduler.shouldRender()) {
+            continue;
+        }
+
+        // Ход во всех партиях
+        for (auto& wallGame : games) {
+            AiGame& game = *wallGame->game;
+            if (game.finished()) {
+                if (++wallGame->finishedFrames >= FINISHED_FRAMES) {
+                    wallGame->finishedFrames = 0;
+                    game.start(wallGame->rng);
+                }
+                continue;
+            }
+            for (int shot = 0; shot < options.shotsPerFrame; ++shot) {
+                if (game.step(wallGame->rng)) {
+                    played++;
+                    wins[game.result().winner]++;
+                    break;
+                }
+            }
+        }
+
+        // Все поля одним вызовом
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+        SDL_RenderClear(renderer);
+        int tileWidth = (2 * BOARD_SIZE + 2) * layout.step;
+        int tileHeight = (BOARD_SIZE + 1) * layout.step;
+        for (int i = 0; i < options.games; ++i) {
+            int x = layout.left + (i % layout.columns) * tileWidth;
+            int y = layout.top + (i / layout.columns) * tileHeight;
+            const AiGame& game = *games[i]->game;
+            boards.queue(game.board(0), x, y, layout.cellSize, layout.step, true);
+            boards.queue(game.board(1), x + (BOARD_SIZE + 1) * layout.step, y, layout.cellSize, layout.step, true);
+        }
+        boards.flush(renderer);
+
+        text.draw(renderer, title + ": партий " + std::to_string(played) + ", победы " +
+                  std::to_string(wins[0]) + ":" + std::to_string(wins[1]), 6, 6, white);
+        SDL_RenderPresent(renderer);
+        scheduler.presented();
+        scheduler.invalidate();
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include "Frame_scheduler.h"
+#include "Text_atlas.h"
+
+//-----------// Режим зрителя: стена из многих партий компьютер против компьютера
+
+// Все партии идут одновременно, каждый кадр в каждой делается выстрел, и все поля
+// рисуются через BoardRenderer одним вызовом. Законченная партия недолго остаётся
+// на экране и начинается заново.
+struct WallOptions {
+    int games = 0;                  // сколько партий на стене; 0 - обычная игра
+    std::string first = "hunt";     // стратегии сторон (см. makeOpponent)
+    std::string second = "hunt";
+    int shotsPerFrame = 1;          // выстрелов в каждой партии за кадр
+};
+
+// Настройки из командной строки: --wall N, --ai NAME, --vs NAME (по умолчанию как --ai), --speed K
+WallOptions parseWallOptions(int argc, char* argv[]);
+
+// Показывать стену, пока не закроют окно или не нажмут Esc
+void runSpectatorWall(SDL_Renderer* renderer, TextAtlas& text, const WallOptions& options,
+                      const RenderSettings& settings);
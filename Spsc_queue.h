@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+//-----------// Очередь без блокировок для одного писателя и одного читателя
+
+// Кольцо фиксированного размера: писатель двигает только tail, читатель только head,
+// поэтому хватает двух атомарных счётчиков. Счётчики лежат в разных строках кэша,
+// чтобы потоки не мешали друг другу. Capacity - степень двойки.
+template<class T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Только из потока-писателя; false - очередь полна
+    bool push(const T& item) {
+        size_t tailNow = tail.load(std::memory_order_relaxed);
+        if (tailNow - head.load(std::memory_order_acquire) == Capacity) return false;
+        items[tailNow & (Capacity - 1)] = item;
+        tail.store(tailNow + 1, std::memory_order_release);
+        return true;
+    }
+    // Только из потока-читателя; false - очередь пуста
+    bool pop(T& item) {
+        size_t headNow = head.load(std::memory_order_relaxed);
+        if (headNow == tail.load(std::memory_order_acquire)) return false;
+        item = items[headNow & (Capacity - 1)];
+        head.store(headNow + 1, std::memory_order_release);
+        return true;
+    }
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    alignas(64) T items[Capacity];
+};
@@ -0,0 +1,159 @@
+#include "Text_atlas.h"
+#include <iostream>
+
+namespace {
+
+const int ATLAS_WIDTH = 1024;
+const int GLYPH_PADDING = 1;
+
+// Следующий символ UTF-8; некорректные байты пропускаются как '?'
+Uint32 nextCodepoint(std::string_view text, size_t& i) {
+    unsigned char c = static_cast<unsigned char>(text[i++]);
+    if (c < 0x80) return c;
+    int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+    if (extra == 0) return '?';
+    Uint32 codepoint = c & (0x3F >> extra);
+    for (int k = 0; k < extra; ++k) {
+        if (i >= text.size() || (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) return '?';
+        codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[i++]) & 0x3F);
+    }
+    return codepoint;
+}
+
+// Символ, которому соответствует номер глифа
+Uint32 slotCodepoint(int slot) {
+    return slot < 128 ? static_cast<Uint32>(slot) : static_cast<Uint32>(0x400 + slot - 128);
+}
+
+}
+
+TextAtlas::~TextAtlas() {
+    destroy();
+}
+
+int TextAtlas::glyphSlot(Uint32 codepoint) {
+    if (codepoint >= 32 && codepoint < 127) return static_cast<int>(codepoint);
+    if (codepoint >= 0x400 && codepoint < 0x460) return static_cast<int>(128 + codepoint - 0x400);
+    return '?';
+}
+
+// Растеризовать глифы шрифта; false, если не удалось создать текстуру
+bool TextAtlas::load(SDL_Renderer* renderer, TTF_Font* font) {
+    destroy();
+    height = TTF_FontHeight(font);
+    SDL_Color white = { 255, 255, 255, 255 };
+
+    // Растеризуем все глифы и раскладываем их по строкам атласа
+    SDL_Surface* rendered[SLOT_COUNT] = {};
+    int penX = 0;
+    int penY = 0;
+    for (int slot = 32; slot < SLOT_COUNT; ++slot) {
+        Uint32 codepoint = slotCodepoint(slot);
+        if (slot == 127 || !TTF_GlyphIsProvided32(font, codepoint)) continue;
+        int advance = 0;
+        if (TTF_GlyphMetrics32(font, codepoint, nullptr, nullptr, nullptr, nullptr, &advance) != 0) continue;
+        SDL_Surface* surface = TTF_RenderGlyph32_Solid(font, codepoint, white);
+        if (surface == nullptr) continue;
+
+        if (penX + surface->w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += height + GLYPH_PADDING;
+        }
+        glyphs[slot].source = { penX, penY, surface->w, surface->h };
+        glyphs[slot].advance = advance;
+        glyphs[slot].present = true;
+        rendered[slot] = surface;
+        penX += surface->w + GLYPH_PADDING;
+    }
+    atlasWidth = ATLAS_WIDTH;
+    atlasHeight = penY + height + GLYPH_PADDING;
+
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    if (atlas != nullptr) {
+        SDL_SetSurfaceBlendMode(atlas, SDL_BLENDMODE_NONE);
+        for (int slot = 0; slot < SLOT_COUNT; ++slot) {
+            if (rendered[slot] == nullptr) continue;
+            SDL_Rect target = glyphs[slot].source;
+            SDL_BlitSurface(rendered[slot], nullptr, atlas, &target);
+        }
+        texture = SDL_CreateTextureFromSurface(renderer, atlas);
+        SDL_FreeSurface(atlas);
+    }
+    for (SDL_Surface* surface : rendered) {
+        if (surface != nullptr) SDL_FreeSurface(surface);
+    }
+    if (texture == nullptr) {
+        std::cerr << "Failed to create glyph atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    // Неизвестные символы рисуются как '?'
+    if (!glyphs['?'].present) {
+        std::cerr << "Font has no '?' glyph" << std::endl;
+    }
+    return true;
+}
+
+void TextAtlas::destroy() {
+    if (texture != nullptr) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    for (Glyph& glyph : glyphs) glyph.present = false;
+}
+
+// Добавить строку UTF-8 в очередь (левый верхний угол в x, y)
+void TextAtlas::queue(std::string_view text, int x, int y, SDL_Color color) {
+    float u = 1.0f / atlasWidth;
+    float v = 1.0f / atlasHeight;
+    int penX = x;
+    size_t i = 0;
+    while (i < text.size()) {
+        Uint32 codepoint = nextCodepoint(text, i);
+        const Glyph& glyph = glyphs[glyphSlot(codepoint)];
+        if (!glyph.present) continue;
+
+        const SDL_Rect& s = glyph.source;
+        float left = static_cast<float>(penX);
+        float top = static_cast<float>(y);
+        float right = left + s.w;
+        float bottom = top + s.h;
+        int base = static_cast<int>(vertices.size());
+        vertices.push_back({ { left, top }, color, { s.x * u, s.y * v } });
+        vertices.push_back({ { right, top }, color, { (s.x + s.w) * u, s.y * v } });
+        vertices.push_back({ { right, bottom }, color, { (s.x + s.w) * u, (s.y + s.h) * v } });
+        vertices.push_back({ { left, bottom }, color, { s.x * u, (s.y + s.h) * v } });
+        int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        indices.insert(indices.end(), quad, quad + 6);
+
+        penX += glyph.advance;
+    }
+}
+
+// Нарисовать всё, что накопилось в очереди, одним вызовом
+void TextAtlas::flush(SDL_Renderer* renderer) {
+    if (!indices.empty() && texture != nullptr) {
+        SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+    }
+    vertices.clear();
+    indices.clear();
+}
+
+// Сразу нарисовать одну строку
+void TextAtlas::draw(SDL_Renderer* renderer, std::string_view text, int x, int y, SDL_Color color) {
+    queue(text, x, y, color);
+    flush(renderer);
+}
+
+// Ширина строки в пикселях
+int TextAtlas::width(std::string_view text) const {
+    int total = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        const Glyph& glyph = glyphs[glyphSlot(nextCodepoint(text, i))];
+        if (glyph.present) total += glyph.advance;
+    }
+    return total;
+}
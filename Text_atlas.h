@@ -0,0 +1,49 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <string_view>
+#include <vector>
+
+//-----------// Вывод текста через атлас глифов
+
+// Латиница и кириллица шрифта растеризуются один раз в одну текстуру при загрузке.
+// Строка рисуется как набор четырёхугольников из этой текстуры одним вызовом
+// SDL_RenderGeometry, без создания поверхностей и текстур на каждом кадре.
+class TextAtlas {
+public:
+    ~TextAtlas();
+
+    // Растеризовать глифы шрифта; false, если не удалось создать текстуру
+    bool load(SDL_Renderer* renderer, TTF_Font* font);
+    void destroy();
+
+    // Добавить строку UTF-8 в очередь (левый верхний угол в x, y). Строка не копируется
+    void queue(std::string_view text, int x, int y, SDL_Color color);
+    // Нарисовать всё, что накопилось в очереди, одним вызовом
+    void flush(SDL_Renderer* renderer);
+    // Сразу нарисовать одну строку
+    void draw(SDL_Renderer* renderer, std::string_view text, int x, int y, SDL_Color color);
+    // Ширина строки в пикселях
+    int width(std::string_view text) const;
+    int lineHeight() const { return height; }
+
+private:
+    struct Glyph {
+        SDL_Rect source;    // место в атласе
+        int advance;        // сдвиг пера после символа
+        bool present;
+    };
+
+    // Номер глифа для символа: ASCII и кириллица U+0400..U+045F, остальное - '?'
+    static int glyphSlot(Uint32 codepoint);
+
+    static const int SLOT_COUNT = 128 + 0x60;
+
+    SDL_Texture* texture = nullptr;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    int height = 0;
+    Glyph glyphs[SLOT_COUNT] = {};
+    std::vector<SDL_Vertex> vertices;   // буферы переиспользуются между кадрами
+    std::vector<int> indices;
+};
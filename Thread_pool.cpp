@@ -0,0 +1,100 @@
+#include "Thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(new Worker());
+    }
+    for (int i = 0; i < threads; ++i) {
+        workers[i]->thread = std::thread(&ThreadPool::loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker->thread.join();
+}
+
+// Выполнить task(index, worker) для index от 0 до count - 1 и дождаться завершения
+void ThreadPool::run(int count, TaskRef task) {
+    if (count <= 0) return;
+    std::lock_guard<std::mutex> single(runLock);
+
+    {
+        std::lock_guard<std::mutex> state(stateLock);
+        current = &task;
+        pending = count;
+    }
+    // Раздаём задачи по очередям по кругу
+    int threads = size();
+    for (int t = 0; t < threads; ++t) {
+        Worker& worker = *workers[t];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        worker.jobs.clear();
+        worker.first = 0;
+        for (int job = t; job < count; job += threads) {
+            worker.jobs.push_back(job);
+        }
+    }
+
+    std::unique_lock<std::mutex> state(stateLock);
+    generation++;
+    wake.notify_all();
+    finished.wait(state, [this]() { return pending == 0; });
+    current = nullptr;
+}
+
+bool ThreadPool::popJob(int self, int& job) {
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.first < own.jobs.size()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+    int threads = size();
+    for (int i = 1; i < threads; ++i) {
+        Worker& victim = *workers[(self + i) % threads];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.first < victim.jobs.size()) {
+            job = victim.jobs[victim.first++];
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::loop(int self) {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> state(stateLock);
+            wake.wait(state, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        int job;
+        while (popJob(self, job)) {
+            // Пока задача не выполнена, run не вернётся и current не поменяется
+            (*current.load())(job, self);
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> state(stateLock);
+                finished.notify_all();
+            }
+        }
+    }
+}
+
+// Общий пул на все ядра (создаётся при первом обращении)
+ThreadPool& defaultThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
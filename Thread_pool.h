@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------// Пул потоков с перехватом работы
+
+// Ссылка на задачу run: не копирует её и не выделяет память, поэтому run можно звать
+// на каждом ходу. Объект задачи живёт у вызывающего, пока run не вернётся
+class TaskRef {
+public:
+    template<class Task>
+    TaskRef(const Task& task)
+        : object(&task), call([](const void* o, int index, int worker) { (*static_cast<const Task*>(o))(index, worker); }) {
+    }
+    void operator()(int index, int worker) const { call(object, index, worker); }
+
+private:
+    const void* object;
+    void (*call)(const void* object, int index, int worker);
+};
+
+// У каждого потока своя очередь задач. Поток берёт задачи с конца своей очереди,
+// а когда она пустеет - забирает их с начала чужих. Очереди - номера задач в векторах,
+// которые переиспользуются между вызовами run
+class ThreadPool {
+public:
+    // threads == 0 - по числу ядер
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    int size() const { return static_cast<int>(workers.size()); }
+    // Выполнить task(index, worker) для index от 0 до count - 1 и дождаться завершения
+    void run(int count, TaskRef task);
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::vector<int> jobs;  // невыполненные - от first до конца
+        size_t first = 0;
+        std::thread thread;
+    };
+
+    bool popJob(int self, int& job);
+    void loop(int self);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<const TaskRef*> current{ nullptr };
+    std::mutex runLock;                 // одновременно выполняется только один run
+    std::mutex stateLock;
+    std::condition_variable wake;       // появились задачи или пора выходить
+    std::condition_variable finished;   // все задачи run выполнены
+    std::atomic<int> pending{ 0 };
+    unsigned generation = 0;
+    bool stopping = false;
+};
+
+// Общий пул на все ядра (создаётся при первом обращении)
+ThreadPool& defaultThreadPool();
@@ -0,0 +1,191 @@
+#include "Tournament.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "Self_play.h"
+#include "Thread_pool.h"
+
+namespace {
+
+// Партий в одной пачке: пачка - единица работы потока и генератора
+const long long BATCH_GAMES = 64;
+
+// Итог пачки партий одной пары
+struct BatchResult {
+    long long wins[2] = { 0, 0 };
+    long long shotsToWin[2][CELL_COUNT + 1] = {};
+};
+
+// Рейтинг по модели Брэдли - Терри (итерации минорирования-максимизации).
+// К счёту каждой сыгравшей пары добавляется по половине победы, чтобы у стратегии
+// без единой победы рейтинг оставался конечным. Шкала Эло, средний рейтинг 1500
+std::vector<double> eloRatings(const std::vector<std::vector<long long>>& wins) {
+    size_t n = wins.size();
+    std::vector<double> strength(n, 1.0);
+    for (int iteration = 0; iteration < 10000; ++iteration) {
+        double change = 0;
+        for (size_t a = 0; a < n; ++a) {
+            double won = 0, weight = 0;
+            for (size_t b = 0; b < n; ++b) {
+                double games = static_cast<double>(wins[a][b] + wins[b][a]);
+                if (a == b || games == 0) continue;
+                won += wins[a][b] + 0.5;
+                weight += (games + 1) / (strength[a] + strength[b]);
+            }
+            if (weight == 0) continue;
+            double updated = won / weight;
+            change = std::max(change, std::fabs(std::log(updated / strength[a])));
+            strength[a] = updated;
+        }
+        // Сила определена с точностью до множителя: среднее логарифмов держится нулевым
+        double meanLog = 0;
+        for (double s : strength) meanLog += std::log(s);
+        meanLog /= static_cast<double>(n);
+        for (double& s : strength) s /= std::exp(meanLog);
+        if (change < 1e-10) break;
+    }
+    std::vector<double> elo(n);
+    for (size_t a = 0; a < n; ++a) elo[a] = 1500 + 400 * std::log10(strength[a]);
+    return elo;
+}
+
+// Строка CSV: кавычки, если в имени есть запятая или кавычка
+std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"") == std::string::npos) return text;
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+}
+
+double TournamentStanding::shotsMean() const {
+    double sum = 0;
+    for (int shots = 0; shots <= CELL_COUNT; ++shots) sum += static_cast<double>(shotsToWin[shots]) * shots;
+    return wins ? sum / wins : 0;
+}
+
+double TournamentStanding::shotsStddev() const {
+    if (wins == 0) return 0;
+    double mean = shotsMean(), sum = 0;
+    for (int shots = 0; shots <= CELL_COUNT; ++shots) sum += shotsToWin[shots] * (shots - mean) * (shots - mean);
+    return std::sqrt(sum / wins);
+}
+
+// Наименьшее число выстрелов, которого хватило доле fraction побед (-1, если побед нет)
+int TournamentStanding::shotsPercentile(double fraction) const {
+    if (wins == 0) return -1;
+    long long needed = std::max(1ll, static_cast<long long>(std::ceil(fraction * wins)));
+    long long seen = 0;
+    for (int shots = 0; shots <= CELL_COUNT; ++shots) {
+        seen += shotsToWin[shots];
+        if (seen >= needed) return shots;
+    }
+    return CELL_COUNT;
+}
+
+// Сыграть турнир; players должны быть известными стратегиями
+TournamentResult runTournament(const TournamentOptions& options) {
+    size_t n = options.players.size();
+    std::vector<std::pair<int, int>> pairs;
+    for (size_t a = 0; a < n; ++a) {
+        for (size_t b = a + 1; b < n; ++b) pairs.emplace_back(static_cast<int>(a), static_cast<int>(b));
+    }
+    long long batchesPerPair = (options.gamesPerPair + BATCH_GAMES - 1) / BATCH_GAMES;
+    std::vector<BatchResult> batches(static_cast<size_t>(batchesPerPair) * pairs.size());
+
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(options.threads);
+    pool.run(static_cast<int>(batches.size()), [&](int index, int) {
+        const std::pair<int, int>& pair = pairs[static_cast<size_t>(index / batchesPerPair)];
+        long long first = index % batchesPerPair * BATCH_GAMES;
+        long long last = std::min(options.gamesPerPair, first + BATCH_GAMES);
+        // Стратегии создаются заново на каждую пачку: их кэши не зависят от того,
+        // какие пачки поток сыграл раньше. Собственный пул им не нужен - параллельны пачки
+        std::unique_ptr<Opponent> players[2] = { makeOpponent(options.players[pair.first], nullptr),
+                                                 makeOpponent(options.players[pair.second], nullptr) };
+        Rng rng(options.seed + static_cast<uint64_t>(index + 1) * 0x9E3779B97F4A7C15ull);
+        BatchResult& batch = batches[index];
+        for (long long game = first; game < last; ++game) {
+            // В нечётных партиях первым стреляет второй участник пары
+            int swap = static_cast<int>(game & 1);
+            GameResult result = playAiGame(*players[swap], *players[1 - swap], rng);
+            int winner = result.winner ^ swap;
+            batch.wins[winner]++;
+            batch.shotsToWin[winner][result.shots[result.winner]]++;
+        }
+    });
+
+    TournamentResult result;
+    result.wins.assign(n, std::vector<long long>(n, 0));
+    result.standings.resize(n);
+    for (size_t a = 0; a < n; ++a) result.standings[a].name = options.players[a];
+    for (size_t index = 0; index < batches.size(); ++index) {
+        const std::pair<int, int>& pair = pairs[index / static_cast<size_t>(batchesPerPair)];
+        const BatchResult& batch = batches[index];
+        int sides[2] = { pair.first, pair.second };
+        for (int side = 0; side < 2; ++side) {
+            TournamentStanding& standing = result.standings[sides[side]];
+            standing.games += batch.wins[0] + batch.wins[1];
+            standing.wins += batch.wins[side];
+            for (int shots = 0; shots <= CELL_COUNT; ++shots) standing.shotsToWin[shots] += batch.shotsToWin[side][shots];
+            result.wins[sides[side]][sides[1 - side]] += batch.wins[side];
+        }
+        result.games += batch.wins[0] + batch.wins[1];
+    }
+    std::vector<double> elo = eloRatings(result.wins);
+    for (size_t a = 0; a < n; ++a) result.standings[a].elo = elo[a];
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Таблица участников в CSV (по убыванию рейтинга); false при ошибке записи
+bool writeStandingsCsv(const TournamentResult& result, const std::string& path) {
+    std::vector<const TournamentStanding*> order;
+    for (const TournamentStanding& standing : result.standings) order.push_back(&standing);
+    std::stable_sort(order.begin(), order.end(),
+                     [](const TournamentStanding* a, const TournamentStanding* b) { return a->elo > b->elo; });
+
+    std::ofstream file(path, std::ios::trunc);
+    file << "player,elo,games,wins,win_rate,shots_mean,shots_stddev,shots_min,shots_p10,shots_p50,shots_p90,shots_max\n";
+    for (const TournamentStanding* s : order) {
+        file << csvField(s->name) << ',' << std::lround(s->elo) << ',' << s->games << ',' << s->wins << ','
+             << s->winRate() << ',' << s->shotsMean() << ',' << s->shotsStddev() << ','
+             << s->shotsPercentile(0) << ',' << s->shotsPercentile(0.1) << ',' << s->shotsPercentile(0.5) << ','
+             << s->shotsPercentile(0.9) << ',' << s->shotsPercentile(1) << '\n';
+    }
+    file.close();
+    if (file.fail()) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Счёт каждой пары в CSV; false при ошибке записи
+bool writeMatchesCsv(const TournamentResult& result, const std::string& path) {
+    std::ofstream file(path, std::ios::trunc);
+    file << "player,opponent,games,wins,losses,win_rate\n";
+    size_t n = result.standings.size();
+    for (size_t a = 0; a < n; ++a) {
+        for (size_t b = 0; b < n; ++b) {
+            long long games = result.wins[a][b] + result.wins[b][a];
+            if (a == b || games == 0) continue;
+            file << csvField(result.standings[a].name) << ',' << csvField(result.standings[b].name) << ','
+                 << games << ',' << result.wins[a][b] << ',' << result.wins[b][a] << ','
+                 << static_cast<double>(result.wins[a][b]) / games << '\n';
+        }
+    }
+    file.close();
+    if (file.fail()) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
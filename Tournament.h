@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Board.h"
+
+//-----------// Турнир стратегий: каждая с каждой, рейтинг Эло
+
+// Партии пары разбиты на пачки, у каждой пачки свой генератор, засеянный номером пачки.
+// Пачки раздаются потокам пула в любом порядке, а итог от этого не зависит: один и тот же
+// seed даёт одинаковую таблицу на любом числе потоков (кроме стратегий с бюджетом по времени).
+// Партии играются теми же функциями правил, что и в игре с окном (playAiGame).
+
+// Параметры турнира
+struct TournamentOptions {
+    std::vector<std::string> players;   // стратегии (см. makeOpponent)
+    long long gamesPerPair = 1000;      // партий в каждой паре; первый ход по очереди
+    int threads = 0;                    // 0 - по числу ядер
+    uint64_t seed = 1;
+};
+
+// Итог одного участника
+struct TournamentStanding {
+    std::string name;
+    double elo = 0;
+    long long games = 0;
+    long long wins = 0;
+    // Выстрелов до победы в выигранных партиях: число партий по числу выстрелов
+    long long shotsToWin[CELL_COUNT + 1] = {};
+
+    double winRate() const { return games ? static_cast<double>(wins) / games : 0; }
+    double shotsMean() const;
+    double shotsStddev() const;
+    // Наименьшее число выстрелов, которого хватило доле fraction побед (-1, если побед нет)
+    int shotsPercentile(double fraction) const;
+};
+
+// Итог турнира
+struct TournamentResult {
+    std::vector<TournamentStanding> standings;  // в порядке options.players
+    std::vector<std::vector<long long>> wins;   // wins[a][b] - побед a над b
+    long long games = 0;
+    double seconds = 0;
+};
+
+// Сыграть турнир; players должны быть известными стратегиями
+TournamentResult runTournament(const TournamentOptions& options);
+
+// Таблица участников в CSV (по убыванию рейтинга); false при ошибке записи
+bool writeStandingsCsv(const TournamentResult& result, const std::string& path);
+// Счёт каждой пары в CSV; false при ошибке записи
+bool writeMatchesCsv(const TournamentResult& result, const std::string& path);
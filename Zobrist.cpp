@@ -0,0 +1,48 @@
+#include "Zobrist.h"
+#include "Rng.h"
+
+namespace {
+
+// По одному ключу на клетку в каждом слое видимого поля
+struct ZobristKeys {
+    uint64_t hits[CELL_COUNT];
+    uint64_t misses[CELL_COUNT];
+    uint64_t sunk[CELL_COUNT];
+
+    ZobristKeys() {
+        Rng rng(0x5EA8A771E5ull);
+        for (int cell = 0; cell < CELL_COUNT; ++cell) {
+            hits[cell] = rng.next();
+            misses[cell] = rng.next();
+            sunk[cell] = rng.next();
+        }
+    }
+};
+
+const ZobristKeys& keys() {
+    static const ZobristKeys table;
+    return table;
+}
+
+uint64_t layerKey(Bitboard cells, const uint64_t* layer) {
+    uint64_t key = 0;
+    while (cells.any()) {
+        int cell = cells.lowest();
+        cells.reset(cell);
+        key ^= layer[cell];
+    }
+    return key;
+}
+
+}
+
+uint64_t zobristKey(const Board& view) {
+    const ZobristKeys& k = keys();
+    return layerKey(view.hits, k.hits) ^ layerKey(view.misses, k.misses) ^ layerKey(view.sunk, k.sunk);
+}
+
+uint64_t zobristChange(const Board& before, const Board& after) {
+    const ZobristKeys& k = keys();
+    return layerKey(before.hits ^ after.hits, k.hits) ^ layerKey(before.misses ^ after.misses, k.misses)
+         ^ layerKey(before.sunk ^ after.sunk, k.sunk);
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+#include "Board.h"
+
+//-----------// Ключи позиций по Зобристу
+
+// Ключ видимой части поля (попадания, промахи, потопленные корабли; слой ships не читается).
+// Одинаковые поля дают один ключ, в каком бы порядке ни делались выстрелы. Ключи клеток
+// получаются из постоянного зерна, поэтому совпадают между запусками и машинами
+// и годятся для файлов.
+uint64_t zobristKey(const Board& view);
+// Изменение ключа между двумя полями: считается только по изменившимся клеткам
+uint64_t zobristChange(const Board& before, const Board& after);